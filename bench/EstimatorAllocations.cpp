@@ -0,0 +1,125 @@
+/**
+ * Copyright (c) 2017. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+/**
+ * Counts the heap allocations made by the makespan estimator, per call, once its scratch
+ * space has grown to the size of the workflow (i.e., in steady state).
+ *
+ * Usage: bench_estimator_allocations <DAX file> [<DAX file> ...]
+ *
+ * The makespan cache is disabled, so that every call runs the estimator. The exit
+ * code is 1 if any steady-state call allocates.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <wrench-dev.h>
+
+#include <Util/WorkflowUtil.h>
+#include <Util/DagSnapshot.h>
+
+static unsigned long num_allocations = 0;
+
+void *operator new(std::size_t size) {
+    num_allocations++;
+    void *ptr = std::malloc(size ? size : 1);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void *operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+using namespace wrench;
+
+static const unsigned long HOST_COUNTS[] = {1, 16, 128, 1024, 8192};
+
+/**
+ * @brief Run every estimate once (the full DAG, each level, and each pair of consecutive levels,
+ *        with the level-range, index and bounds entry points, for each number of hosts)
+ * @param dag: a DAG snapshot
+ * @param all_tasks: the indices of all the DAG's tasks
+ * @param num_calls: incremented by the number of estimator calls
+ */
+static void runEstimates(const DagSnapshot &dag, const std::vector<unsigned long> &all_tasks,
+                         unsigned long *num_calls) {
+    unsigned long num_levels = dag.getNumLevels();
+    for (auto num_hosts : HOST_COUNTS) {
+        WorkflowUtil::estimateMakespan(dag, all_tasks, num_hosts, 1.0);
+        WorkflowUtil::estimateMakespan(dag, 0, num_levels - 1, num_hosts, 1.0);
+        WorkflowUtil::makespanBounds(dag, all_tasks, num_hosts, 1.0);
+        *num_calls += 3;
+        for (unsigned long l = 0; l < num_levels; l++) {
+            WorkflowUtil::estimateMakespan(dag, l, l, num_hosts, 1.0);
+            WorkflowUtil::estimateMakespan(dag, l, l + 1, num_hosts, 1.0);
+            WorkflowUtil::makespanBounds(dag, l, l + 1, num_hosts, 1.0);
+            *num_calls += 3;
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <DAX file> [<DAX file> ...]\n";
+        exit(1);
+    }
+
+    WorkflowUtil::setMakespanCacheCapacity(0);
+
+    bool allocation_free = true;
+
+    for (int i = 1; i < argc; i++) {
+        Workflow *workflow = PegasusWorkflowParser::createWorkflowFromDAX(argv[i], "1");
+        auto dag = WorkflowUtil::getDagSnapshot(workflow);
+        std::vector<unsigned long> all_tasks = dag->getIndicesInTopLevelRange(0, dag->getNumLevels() - 1);
+
+        // The first pass grows the scratch space
+        unsigned long num_calls = 0;
+        unsigned long allocations_before = num_allocations;
+        runEstimates(*dag, all_tasks, &num_calls);
+        unsigned long warmup_allocations = num_allocations - allocations_before;
+
+        num_calls = 0;
+        allocations_before = num_allocations;
+        runEstimates(*dag, all_tasks, &num_calls);
+        unsigned long steady_allocations = num_allocations - allocations_before;
+
+        fprintf(stdout, "%s: %lu tasks, %lu levels, %lu calls: %.3lf allocations/call (warm-up: %.3lf)\n",
+                argv[i], dag->getNumTasks(), dag->getNumLevels(), num_calls,
+                (double) steady_allocations / num_calls, (double) warmup_allocations / num_calls);
+
+        if (steady_allocations > 0) {
+            allocation_free = false;
+        }
+    }
+
+    return (allocation_free ? 0 : 1);
+}
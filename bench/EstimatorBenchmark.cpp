@@ -0,0 +1,141 @@
+/**
+ * Copyright (c) 2017. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+/**
+ * Times WorkflowUtil::estimateMakespan() on the DAX workflows of a directory (by default,
+ * the bundled docker/data/workflows), over the full DAG, over each level, and over each
+ * range of two or more levels, for several numbers of hosts.
+ *
+ * Usage: bench_estimator [<Google Benchmark options>] [<workflow directory>]
+ *
+ * Each benchmark iteration is one estimator call (iterations cycle through the levels or
+ * level ranges), so the reported time is per call. The "tasks/s" counter is the number of
+ * tasks estimated per second. The makespan cache is disabled, so that every call runs the
+ * estimator.
+ */
+
+#include <algorithm>
+#include <dirent.h>
+#include <iostream>
+#include <benchmark/benchmark.h>
+#include <wrench-dev.h>
+
+#include <Util/WorkflowUtil.h>
+#include <Util/DagSnapshot.h>
+
+#ifndef BENCH_WORKFLOW_DIR
+#define BENCH_WORKFLOW_DIR "docker/data/workflows"
+#endif
+
+using namespace wrench;
+
+static const unsigned long HOST_COUNTS[] = {1, 16, 128, 1024, 8192};
+static const double CORE_SPEED = 1.0;
+
+/**
+ * @brief Benchmark estimator calls, cycling through level ranges
+ * @param state: the benchmark state
+ * @param dag: the workflow's DAG snapshot
+ * @param level_ranges: the (first level, last level) ranges
+ * @param num_hosts: the number of hosts
+ */
+static void benchmarkEstimateMakespan(benchmark::State &state, std::shared_ptr<DagSnapshot> dag,
+                                      std::vector<std::pair<unsigned long, unsigned long>> level_ranges,
+                                      unsigned long num_hosts) {
+    unsigned long next_range = 0;
+    double num_tasks = 0;
+    for (auto _ : state) {
+        auto range = level_ranges[next_range];
+        benchmark::DoNotOptimize(
+                WorkflowUtil::estimateMakespan(*dag, range.first, range.second, num_hosts, CORE_SPEED));
+        num_tasks += dag->getLevelEnd(range.second) - dag->getLevelBegin(range.first);
+        next_range = (next_range + 1) % level_ranges.size();
+    }
+    state.counters["tasks/s"] = benchmark::Counter(num_tasks, benchmark::Counter::kIsRate);
+}
+
+/**
+ * @brief Get the paths of the DAX files in a directory
+ * @param directory: a directory
+ * @return the sorted paths
+ */
+static std::vector<std::string> getDAXFiles(std::string directory) {
+    std::vector<std::string> paths;
+    DIR *dir = opendir(directory.c_str());
+    if (dir == nullptr) {
+        throw std::invalid_argument("Cannot open directory " + directory);
+    }
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        std::string name = entry->d_name;
+        if ((name.size() > 4) and (name.substr(name.size() - 4) == ".dax")) {
+            paths.push_back(directory + "/" + name);
+        }
+    }
+    closedir(dir);
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
+int main(int argc, char **argv) {
+
+    benchmark::Initialize(&argc, argv);
+    std::string directory = (argc > 1) ? argv[1] : BENCH_WORKFLOW_DIR;
+
+    std::vector<std::string> paths;
+    try {
+        paths = getDAXFiles(directory);
+    } catch (std::invalid_argument &e) {
+        std::cerr << e.what() << "\n";
+        exit(1);
+    }
+    if (paths.empty()) {
+        std::cerr << "No DAX file in " << directory << "\n";
+        exit(1);
+    }
+
+    WorkflowUtil::setMakespanCacheCapacity(0);
+
+    for (auto const &path : paths) {
+        Workflow *workflow = PegasusWorkflowParser::createWorkflowFromDAX(path, "1");
+        auto dag = WorkflowUtil::getDagSnapshot(workflow);
+        unsigned long num_levels = dag->getNumLevels();
+
+        std::string name = path.substr(path.find_last_of('/') + 1);
+        name = name.substr(0, name.size() - 4);
+
+        std::vector<std::pair<unsigned long, unsigned long>> full = {{0, num_levels - 1}};
+        std::vector<std::pair<unsigned long, unsigned long>> levels;
+        std::vector<std::pair<unsigned long, unsigned long>> ranges;
+        for (unsigned long s = 0; s < num_levels; s++) {
+            levels.push_back(std::make_pair(s, s));
+            for (unsigned long e = s + 1; e < num_levels; e++) {
+                ranges.push_back(std::make_pair(s, e));
+            }
+        }
+
+        for (auto num_hosts : HOST_COUNTS) {
+            std::string suffix = "/hosts:" + std::to_string(num_hosts);
+            benchmark::RegisterBenchmark(("estimateMakespan/" + name + "/full" + suffix).c_str(),
+                                         benchmarkEstimateMakespan, dag, full, num_hosts)
+                    ->Unit(benchmark::kNanosecond);
+            benchmark::RegisterBenchmark(("estimateMakespan/" + name + "/levels" + suffix).c_str(),
+                                         benchmarkEstimateMakespan, dag, levels, num_hosts)
+                    ->Unit(benchmark::kNanosecond);
+            if (not ranges.empty()) {
+                benchmark::RegisterBenchmark(("estimateMakespan/" + name + "/ranges" + suffix).c_str(),
+                                             benchmarkEstimateMakespan, dag, ranges, num_hosts)
+                        ->Unit(benchmark::kNanosecond);
+            }
+        }
+    }
+
+    benchmark::RunSpecifiedBenchmarks();
+    return 0;
+}
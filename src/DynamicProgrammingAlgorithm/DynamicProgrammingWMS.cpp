@@ -0,0 +1,228 @@
+/**
+* Copyright (c) 2019. The WRENCH Team.
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*/
+
+#include "DynamicProgrammingWMS.h"
+#include <Util/WorkflowUtil.h>
+#include <Util/DagSnapshot.h>
+#include <Util/LevelRangeSchedule.h>
+#include <Util/QueryProfiler.h>
+#include "Globals.h"
+
+XBT_LOG_NEW_DEFAULT_CATEGORY(dp_wms, "Log category for Dynamic Programming WMS");
+
+namespace wrench {
+
+    DynamicProgrammingWMS::DynamicProgrammingWMS(Simulator *simulator, std::string hostname, double waste_bound,
+                                                 bool use_wait_time_surface,
+                                                 std::shared_ptr<BatchComputeService> batch_service) :
+            LevelGroupingWMS(simulator, hostname, waste_bound, use_wait_time_surface, batch_service) {
+        this->num_segment_configurations = 0;
+        this->num_segments = 0;
+    }
+
+    /**
+     * @brief Write the plan statistics to the JSON output
+     */
+    void DynamicProgrammingWMS::reportStatistics() {
+        Globals::sim_json["planned_num_groups"] = this->planned_num_groups;
+        Globals::sim_json["dp_search"]["segments"] = this->num_segments;
+        Globals::sim_json["dp_search"]["configurations"] = this->num_segment_configurations;
+    }
+
+    /**
+     * @brief Plan the partition of the remaining levels into consecutive jobs that minimizes the predicted
+     *        makespan, and submit the first job of that plan
+     *
+     * A job (segment) that runs levels a-b on n nodes costs its wait time plus its makespan, minus the
+     * part of its wait time that overlaps with the execution of the previous job (each job is submitted
+     * when the previous one starts). The makespans of all segments and of a few node counts each are
+     * computed once, by extending a list schedule from each start level, and the wait times of all of
+     * them are estimated with a single request, so that the plan costs O(L^2) segment evaluations.
+     * Since that overlap depends on the previous job's configuration, the plan is searched over
+     * (segment, node count) configurations: with C of them, that is O(C^2 / L) steps, i.e.,
+     * O(L^3 log^2(num_hosts)).
+     */
+    void DynamicProgrammingWMS::applyGroupingHeuristic() {
+        QueryProfiler::Phase phase("grouping");
+
+        WRENCH_INFO("APPLYING GROUPING HEURISTIC");
+
+        if (this->pending_placeholder_job) {
+            return;
+        }
+
+        unsigned long start_level = this->proxyWMS->getStartLevel(this->running_placeholder_jobs);
+        unsigned long end_level = this->getWorkflow()->getNumLevels() - 1;
+
+        if (start_level > end_level) {
+            return;
+        }
+
+        unsigned long num_levels = end_level - start_level + 1;
+
+        double parent_runtime = this->proxyWMS->findMaxDuration(this->running_placeholder_jobs);
+
+        WRENCH_INFO("Parent job runtime: %lf", parent_runtime);
+
+        if (this->use_wait_time_surface) {
+            // Answer (almost) all wait time estimates below with a single batch service request: no
+            // requested execution time exceeds the total work plus the largest leeway
+            double total_work = WorkflowUtil::getDagSnapshot(this->getWorkflow())->getLevelRangeFlops(
+                    start_level, end_level) / this->core_speed;
+            this->proxyWMS->buildWaitTimeSurface(start_level, end_level, findMaxParallelism(start_level, end_level),
+                                                 total_work + std::max<double>(parent_runtime, total_work),
+                                                 this->simulation->getCurrentSimulatedDate(), &this->sequence);
+        }
+
+        // Runtimes of the segments (levels start_level+a to start_level+b) for node counts that are powers of
+        // two below the segment's maximum parallelism, and for that maximum parallelism (or, if all of them
+        // are too wasteful, for one node, so that every partition has a plan)
+        std::vector<unsigned long> segment_start;
+        std::vector<unsigned long> segment_end;
+        std::vector<std::pair<unsigned long, double>> configurations;
+        std::vector<std::vector<unsigned long>> configurations_by_end(num_levels);
+        {
+            QueryProfiler::Phase phase("parallelism");
+
+            auto dag = WorkflowUtil::getDagSnapshot(this->getWorkflow());
+            for (unsigned long a = 0; a < num_levels; a++) {
+                std::map<unsigned long, std::unique_ptr<LevelRangeSchedule>> schedules;
+                unsigned long max_parallelism = 0;
+                for (unsigned long b = a; b < num_levels; b++) {
+                    unsigned long previous_max_parallelism = max_parallelism;
+                    max_parallelism = std::min<unsigned long>(
+                            std::max<unsigned long>(max_parallelism, dag->getNumTasksInLevel(start_level + b)),
+                            this->number_of_hosts);
+                    if ((previous_max_parallelism != max_parallelism) and (previous_max_parallelism > 0) and
+                        ((previous_max_parallelism & (previous_max_parallelism - 1)) != 0)) {
+                        // No longer one of the node counts of the segments that start at level a
+                        schedules.erase(previous_max_parallelism);
+                    }
+
+                    std::vector<unsigned long> node_counts;
+                    for (unsigned long n = 1; n < max_parallelism; n *= 2) {
+                        node_counts.push_back(n);
+                    }
+                    node_counts.push_back(max_parallelism);
+
+                    bool viable = false;
+                    for (auto n : node_counts) {
+                        auto schedule = schedules.find(n);
+                        if (schedule == schedules.end()) {
+                            schedules[n].reset(new LevelRangeSchedule(dag, start_level + a, start_level + b, n,
+                                                                      this->core_speed));
+                        } else {
+                            schedule->second->extendTo(start_level + b);
+                        }
+                        double runtime = schedules[n]->getMakespan();
+                        if (isTooWasteful(runtime, n, start_level + a, start_level + b)) {
+                            continue;
+                        }
+                        viable = true;
+                        configurations_by_end[b].push_back(configurations.size());
+                        segment_start.push_back(a);
+                        segment_end.push_back(b);
+                        configurations.push_back(std::make_pair(n, runtime));
+                    }
+                    if (not viable) {
+                        configurations_by_end[b].push_back(configurations.size());
+                        segment_start.push_back(a);
+                        segment_end.push_back(b);
+                        configurations.push_back(std::make_pair(1, schedules[1]->getMakespan()));
+                    }
+                }
+            }
+        }
+
+        std::vector<double> wait_times = this->proxyWMS->estimateWaitTimes(
+                configurations, this->simulation->getCurrentSimulatedDate(), &this->sequence);
+
+        // makespans[c]: the predicted completion date of the best plan for the levels up to the end of
+        // configuration c whose last job is c (the overlap of a job's wait time with the execution of the
+        // previous job depends on that job's configuration, hence the state); previous_configuration[c]:
+        // the configuration of the job before it (ULONG_MAX if it is the first job)
+        std::vector<double> makespans(configurations.size(), DBL_MAX);
+        std::vector<unsigned long> previous_configuration(configurations.size(), ULONG_MAX);
+        for (unsigned long b = 0; b < num_levels; b++) {
+            for (auto c : configurations_by_end[b]) {
+                unsigned long a = segment_start[c];
+                double wait_time = wait_times[c];
+                double runtime = configurations[c].second;
+                if (a == 0) {
+                    makespans[c] = parent_runtime + wait_time + runtime - std::min<double>(parent_runtime, wait_time);
+                    continue;
+                }
+                for (auto previous : configurations_by_end[a - 1]) {
+                    double makespan = makespans[previous] + wait_time + runtime -
+                                      std::min<double>(configurations[previous].second, wait_time);
+                    if (makespan < makespans[c]) {
+                        makespans[c] = makespan;
+                        previous_configuration[c] = previous;
+                    }
+                }
+            }
+        }
+
+        // Configurations that end at a level are by increasing start level, so ties go to the longest
+        // last job, i.e., to the fewest jobs
+        unsigned long last_configuration = ULONG_MAX;
+        for (auto c : configurations_by_end[num_levels - 1]) {
+            if ((last_configuration == ULONG_MAX) or (makespans[c] < makespans[last_configuration])) {
+                last_configuration = c;
+            }
+        }
+
+        // Walk the plan back to its first job
+        unsigned long first_configuration = last_configuration;
+        unsigned long num_groups = 1;
+        while (previous_configuration[first_configuration] != ULONG_MAX) {
+            first_configuration = previous_configuration[first_configuration];
+            num_groups++;
+        }
+        unsigned long partial_dag_end_level = start_level + segment_end[first_configuration];
+
+        this->num_segment_configurations += configurations.size();
+        this->num_segments += num_levels * (num_levels + 1) / 2;
+
+        WRENCH_INFO("Planned %lu jobs from %lu segment configurations (predicted makespan: %lf)",
+                    num_groups, configurations.size(), makespans[last_configuration]);
+
+        unsigned long requested_parallelism = configurations[first_configuration].first;
+        double requested_execution_time = configurations[first_configuration].second;
+        double estimated_wait_time = wait_times[first_configuration];
+
+        // Calculate leeway needed for the first job vs. currently running parent
+        double max_leeway = std::max<double>(0, (parent_runtime - estimated_wait_time));
+        double best_leeway = this->leeway_solver->findLeeway(
+                requested_execution_time, requested_parallelism, parent_runtime, 0, max_leeway,
+                this->simulation->getCurrentSimulatedDate());
+
+        if (best_leeway > 0) {
+            requested_execution_time += best_leeway;
+            WRENCH_INFO("recalculated runtime: %lf", requested_execution_time);
+        }
+
+        if (partial_dag_end_level < end_level) {
+            this->number_of_splits++;
+        }
+
+        WRENCH_INFO("GROUPING: %ld-%ld", start_level, partial_dag_end_level);
+
+        WRENCH_INFO("Picked end level %lu (1st of %lu jobs): wait time %lf, runtime %lf, parallelism %lu",
+                    partial_dag_end_level, num_groups, estimated_wait_time, requested_execution_time,
+                    requested_parallelism);
+
+        Globals::sim_json["end_levels"].push_back(partial_dag_end_level);
+        this->planned_num_groups.push_back(num_groups);
+
+        this->pending_placeholder_job = this->proxyWMS->createAndSubmitPlaceholderJob(
+                requested_execution_time, requested_parallelism, start_level, partial_dag_end_level);
+    }
+
+};
@@ -0,0 +1,48 @@
+/**
+ * Copyright (c) 2019. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+
+#ifndef TASK_CLUSTERING_BATCH_SIMULATOR_DYNAMICPROGRAMMINGWMS_H
+#define TASK_CLUSTERING_BATCH_SIMULATOR_DYNAMICPROGRAMMINGWMS_H
+
+
+#include <Util/LevelGroupingWMS.h>
+
+namespace wrench {
+
+    /**
+     * @brief A WMS that plans a partition of all remaining levels into consecutive placeholder jobs by
+     *        dynamic programming, and submits the first job of the plan (re-planning each time)
+     */
+    class DynamicProgrammingWMS : public LevelGroupingWMS {
+
+    public:
+
+        DynamicProgrammingWMS(Simulator *simulator, std::string hostname, double waste_bound,
+                              bool use_wait_time_surface, std::shared_ptr<BatchComputeService> batch_service);
+
+    private:
+
+        void applyGroupingHeuristic() override;
+
+        void reportStatistics() override;
+
+        // Number of jobs in each plan
+        std::vector<unsigned long> planned_num_groups;
+
+        // Number of (level range, number of nodes) configurations whose costs the plans were computed from,
+        // and number of level ranges they cover
+        unsigned long num_segment_configurations;
+        unsigned long num_segments;
+};
+
+};
+
+
+#endif //TASK_CLUSTERING_BATCH_SIMULATOR_DYNAMICPROGRAMMINGWMS_H
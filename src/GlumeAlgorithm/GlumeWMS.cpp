@@ -9,51 +9,33 @@
 
 #include "GlumeWMS.h"
 #include <Util/WorkflowUtil.h>
+#include <Util/DagSnapshot.h>
+#include <Util/QueryProfiler.h>
 #include "Globals.h"
 
 XBT_LOG_NEW_DEFAULT_CATEGORY(glume_wms, "Log category for Glume WMS");
 
 namespace wrench {
 
-    static int sequence = 0;
-
     GlumeWMS::GlumeWMS(Simulator *simulator, std::string hostname, double waste_bound,
-                                         double beat_bound, std::shared_ptr<BatchComputeService> batch_service) :
-            WMS(nullptr, nullptr, {batch_service}, {}, {}, nullptr, hostname, "clustering_wms") {
-        this->simulator = simulator;
-        this->waste_bound = waste_bound;
+                                         double beat_bound, bool use_wait_time_surface,
+                                         std::shared_ptr<BatchComputeService> batch_service) :
+            LevelGroupingWMS(simulator, hostname, waste_bound, use_wait_time_surface, batch_service) {
         this->beat_bound = beat_bound;
-        this->batch_service = batch_service;
-        this->pending_placeholder_job = nullptr;
-        this->number_of_splits = 0;
+        this->num_split_candidates = 0;
+        this->num_split_evaluations = 0;
     }
 
-    int GlumeWMS::main() {
-
-        TerminalOutput::setThisProcessLoggingColor(TerminalOutput::COLOR_WHITE);
-
-        this->checkDeferredStart();
-
-        this->core_speed = (*(this->batch_service->getCoreFlopRate().begin())).second;
-        this->number_of_hosts = this->batch_service->getNumHosts();
-        this->job_manager = this->createJobManager();
-        this->proxyWMS = new ProxyWMS(this->getWorkflow(), this->job_manager, this->batch_service);
-
-        Globals::sim_json["end_levels"] = std::vector<unsigned long> ();
-
-        while (not this->getWorkflow()->isDone()) {
-            applyGroupingHeuristic();
-            this->waitForAndProcessNextEvent();
-        }
-
-        WRENCH_INFO("#SPLITS= %lu", this->number_of_splits);
-
-        Globals::sim_json["num_splits"] = this->number_of_splits;
-
-        return 0;
+    /**
+     * @brief Write the split search statistics to the JSON output
+     */
+    void GlumeWMS::reportStatistics() {
+        Globals::sim_json["split_search"]["candidates"] = this->num_split_candidates;
+        Globals::sim_json["split_search"]["evaluations"] = this->num_split_evaluations;
     }
 
     void GlumeWMS::applyGroupingHeuristic() {
+        QueryProfiler::Phase phase("grouping");
 
         WRENCH_INFO("APPLYING GROUPING HEURISTIC");
 
@@ -75,6 +57,16 @@ namespace wrench {
 
         WRENCH_INFO("Parent job runtime: %lf", parent_runtime);
 
+        if (this->use_wait_time_surface) {
+            // Answer (almost) all wait time estimates below with a single batch service request: no
+            // requested execution time exceeds the total work plus the largest leeway
+            double total_work = WorkflowUtil::getDagSnapshot(this->getWorkflow())->getLevelRangeFlops(
+                    start_level, end_level) / this->core_speed;
+            this->proxyWMS->buildWaitTimeSurface(start_level, end_level, findMaxParallelism(start_level, end_level),
+                                                 total_work + std::max<double>(parent_runtime, total_work),
+                                                 this->simulation->getCurrentSimulatedDate(), &this->sequence);
+        }
+
         // Use these to keep track of the "best" grouping
         std::tuple<double, double, unsigned long> entire_workflow = estimateJob(start_level, end_level, parent_runtime);
         double estimated_wait_time = std::get<0>(entire_workflow);
@@ -87,14 +79,15 @@ namespace wrench {
 
         // Calculate leeway needed for entire dag vs. currently running parent
         double max_leeway_entire_dag = std::max<double>(0, (parent_runtime - estimated_wait_time));
-        double best_leeway_entire_dag = calculateLeewayBinarySearch(requested_execution_time, requested_parallelism,
-                                                                    parent_runtime, 0, max_leeway_entire_dag);
+        double best_leeway_entire_dag = this->leeway_solver->findLeeway(
+                requested_execution_time, requested_parallelism, parent_runtime, 0, max_leeway_entire_dag,
+                this->simulation->getCurrentSimulatedDate());
 
         // Adjust the run and wait times for leeway
         if (best_leeway_entire_dag > 0) {
             requested_execution_time += best_leeway_entire_dag;
             estimated_wait_time = this->proxyWMS->estimateWaitTime(requested_parallelism, requested_execution_time,
-                                                        this->simulation->getCurrentSimulatedDate(), &sequence);
+                                                        this->simulation->getCurrentSimulatedDate(), &this->sequence);
             WRENCH_INFO("entire dag recalculated wait_time: %lf",estimated_wait_time);
             WRENCH_INFO("entire dag recalculated runtime: %lf", requested_execution_time);
         }
@@ -106,71 +99,100 @@ namespace wrench {
 
         unsigned long partial_dag_end_level = end_level;
 
-        // Find the best split
-        for (unsigned long i = start_level; i < num_levels - 1; i++) {
-            WRENCH_INFO("Candidate end level: %lu", i);
-
-            std::tuple<double, double, unsigned long> start_to_split = estimateJob(start_level, i, parent_runtime);
-            double wait_one = std::get<0>(start_to_split);
-            double run_one = std::get<1>(start_to_split);
-            unsigned long nodes_one = std::get<2>(start_to_split);
-
-            WRENCH_INFO("1: num nodes: %lu", std::get<2>(start_to_split));
-            WRENCH_INFO("1: wait_time: %lf", wait_one);
-            WRENCH_INFO("1: runtime: %lf", run_one);
-
-            // Calculate leeway needed for first group vs. currently running parent
-            double max_leeway_one = std::max<double>(0, (parent_runtime - wait_one));
-            double best_leeway_one = calculateLeewayBinarySearch(run_one, nodes_one, parent_runtime, 0, max_leeway_one);
-
-            std::cout << "1: leeway needed: " << best_leeway_one << std::endl;
-
-            if (best_leeway_one > (run_one * .1)) {
-                std::cout << "Too much leeway needed - skipping group\n";
-                continue;
+        // Find the best split with a branch-and-bound search: candidate end levels are evaluated in increasing
+        // order of a lower bound on their makespan, and only for as long as one could change the split that
+        // the sequential comparison below picks (which is that of an exhaustive search)
+        double entire_dag_makespan = best_makespan;
+        unsigned long num_candidates = (num_levels - 1 > start_level) ? (num_levels - 1 - start_level) : 0;
+        std::vector<double> lower_bounds(num_candidates);
+        std::vector<bool> evaluated(num_candidates, false);
+        std::vector<double> makespans(num_candidates, DBL_MAX);
+        std::vector<double> waits_one(num_candidates);
+        std::vector<double> runs_one(num_candidates);
+        std::vector<unsigned long> nodes_one(num_candidates);
+
+        if (num_candidates > 0) {
+            // Both groups take at least their makespan lower bounds with as many nodes as they can use, and the
+            // first group waits at least as long as the smallest possible job would (predicted waits never
+            // decrease when a job asks for more nodes or time), while leeways only add to that
+            auto dag = WorkflowUtil::getDagSnapshot(this->getWorkflow());
+            double min_wait_time = this->proxyWMS->estimateWaitTime(1, 0, this->simulation->getCurrentSimulatedDate(),
+                                                                    &this->sequence);
+            for (unsigned long k = 0; k < num_candidates; k++) {
+                unsigned long i = start_level + k;
+                double run_one_lower_bound = WorkflowUtil::makespanBounds(
+                        *dag, start_level, i, findMaxParallelism(start_level, i), this->core_speed).first;
+                double run_two_lower_bound = WorkflowUtil::makespanBounds(
+                        *dag, i + 1, end_level, findMaxParallelism(i + 1, end_level), this->core_speed).first;
+                lower_bounds[k] = min_wait_time + run_one_lower_bound + run_two_lower_bound;
             }
+        }
 
-            // Adjust the run and wait times for leeway
-            if (best_leeway_one > 0) {
-                run_one += best_leeway_one;
-                wait_one = this->proxyWMS->estimateWaitTime(nodes_one, run_one,
-                                                            this->simulation->getCurrentSimulatedDate(), &sequence);
-                std::cout << "1: recalculated wait_time: " << wait_one << std::endl;
-                std::cout << "1: recalculated runtime: " << run_one << std::endl;
+        unsigned long num_evaluations = 0;
+        while (true) {
+            // The first split that beats the entire dag, if it is known for sure
+            unsigned long first_pick = num_candidates;
+            for (unsigned long k = 0; k < num_candidates; k++) {
+                if (evaluated[k] and (makespans[k] < entire_dag_makespan)) {
+                    first_pick = k;
+                    break;
+                }
+            }
+            bool first_pick_known = (first_pick < num_candidates);
+            for (unsigned long k = 0; first_pick_known and (k < first_pick); k++) {
+                if ((not evaluated[k]) and (lower_bounds[k] < entire_dag_makespan)) {
+                    first_pick_known = false;
+                }
             }
 
-            std::tuple<double, double, unsigned long> rest = estimateJob(i + 1, end_level, run_one);
-            double wait_two = std::get<0>(rest);
-            double run_two = std::get<1>(rest);
-            unsigned long nodes_two = std::get<2>(rest);
+            // The best makespan after the first pick (which is adjusted by the beat bound), as it stands
+            double best_makespan_so_far = DBL_MAX;
+            if (first_pick_known) {
+                best_makespan_so_far = makespans[first_pick] + (makespans[first_pick] * beat_bound);
+                for (unsigned long k = first_pick + 1; k < num_candidates; k++) {
+                    if (evaluated[k] and (makespans[k] < best_makespan_so_far)) {
+                        best_makespan_so_far = makespans[k];
+                    }
+                }
+            }
 
-            std::cout << "2: num nodes: " << nodes_two << std::endl;
-            std::cout << "2: wait_time: " << wait_two << std::endl;
-            std::cout << "2: runtime: " << run_two << std::endl;
+            // Until the first pick is known, only a candidate that could beat the entire dag matters. After it,
+            // only a later candidate that could beat (or tie with) the best makespan so far does.
+            unsigned long next = num_candidates;
+            for (unsigned long k = (first_pick_known ? first_pick + 1 : 0); k < num_candidates; k++) {
+                if (evaluated[k]) {
+                    continue;
+                }
+                if (first_pick_known ? (lower_bounds[k] > best_makespan_so_far)
+                                     : (lower_bounds[k] >= entire_dag_makespan)) {
+                    continue;
+                }
+                if ((next == num_candidates) or (lower_bounds[k] < lower_bounds[next])) {
+                    next = k;
+                }
+            }
+            if (next == num_candidates) {
+                break;
+            }
 
-            // Calculate leeway needed for second group vs. first group ^
-            double max_leeway_two = std::max<double>(0, (run_one - wait_two));
-            double best_leeway_two = calculateLeewayBinarySearch(run_two, nodes_two, run_one, 0, max_leeway_two);
+            WRENCH_INFO("Candidate end level: %lu (lower bound %lf)", start_level + next, lower_bounds[next]);
+            makespans[next] = evaluateSplit(start_level, start_level + next, end_level, parent_runtime,
+                                            &waits_one[next], &runs_one[next], &nodes_one[next]);
+            evaluated[next] = true;
+            num_evaluations++;
+        }
 
-            std::cout << "2: leeway needed: " << best_leeway_two << std::endl;
+        WRENCH_INFO("Evaluated %lu of %lu candidate end levels", num_evaluations, num_candidates);
+        this->num_split_candidates += num_candidates;
+        this->num_split_evaluations += num_evaluations;
 
-            if (best_leeway_two > (run_two * .1)) {
-                std::cout << "Too much leeway needed for grouping\n";
+        for (unsigned long k = 0; k < num_candidates; k++) {
+            if (makespans[k] == DBL_MAX) {
+                // Not evaluated, or needs too much leeway
                 continue;
             }
-
-            // Adjust the run and wait times for leeway
-            if (best_leeway_two > 0) {
-                run_two += best_leeway_two;
-                wait_two = this->proxyWMS->estimateWaitTime(nodes_two, run_two,
-                                                            this->simulation->getCurrentSimulatedDate(), &sequence);
-                std::cout << "2: recalculated wait_time: " << wait_two << std::endl;
-                std::cout << "2: recalculated runtime: " << run_two << std::endl;
-            }
-
-            double makespan = wait_one + std::max<double>(run_one, wait_two) + run_two;
-
-            std::cout << "makespan: " << makespan << std::endl;
+            unsigned long i = start_level + k;
+            double makespan = makespans[k];
 
             // Make sure we only compare when one_job-0 is still the best grouping
             // Although, i'm not entirely convinced this is still right...
@@ -184,9 +206,9 @@ namespace wrench {
                 std::cout << "found a better split! @ end level = " << i << std::endl;
                 partial_dag_end_level = i;
                 best_makespan = makespan;
-                requested_execution_time = run_one;
-                requested_parallelism = nodes_one;
-                estimated_wait_time = wait_one;
+                requested_execution_time = runs_one[k];
+                requested_parallelism = nodes_one[k];
+                estimated_wait_time = waits_one[k];
             }
         }
 
@@ -210,346 +232,138 @@ namespace wrench {
                 requested_execution_time, requested_parallelism, start_level, partial_dag_end_level);
     }
 
-    // Return params: (wait time, runtime, num_hosts)
-    std::tuple<double, double, unsigned long>
-    GlumeWMS::estimateJob(unsigned long start_level, unsigned long end_level, double delay) {
-
-        double runtime = DBL_MAX;
-        double wait_time = DBL_MAX;
-        double best_makespan = DBL_MAX;
-        unsigned long best_parallelism = 1;
-
-        unsigned long max_parallelism = findMaxParallelism(start_level, end_level);
-
-        for (unsigned long i = 1; i <= max_parallelism; i++) {
-            std::tuple<double, double> waitAndRun = estimateWaitAndRunTimes(start_level, end_level, i);
-            double curr_wait = std::get<0>(waitAndRun);
-            double curr_runtime = std::get<1>(waitAndRun);
-
-            if (isTooWasteful(curr_runtime, i, start_level, end_level)) {
-                continue;
-            }
-
-            double curr_makespan = std::max<double>(delay, curr_wait) + curr_runtime;
-
-            if (curr_makespan <= best_makespan) {
-                runtime = curr_runtime;
-                wait_time = curr_wait;
-                best_makespan = curr_makespan;
-                best_parallelism = i;
-            }
-        }
-
-        assert(runtime != DBL_MAX && wait_time != DBL_MAX);
-
-        return std::make_tuple(wait_time, runtime, best_parallelism);
-    }
-
-    unsigned long GlumeWMS::findMaxParallelism(unsigned long start_level, unsigned long end_level) {
-        unsigned long max_parallelism = 0;
-        for (unsigned long i = start_level; i <= end_level; i++) {
-            unsigned long num_tasks_in_level = this->getWorkflow()->getTasksInTopLevelRange(i, i).size();
-            max_parallelism = std::max<unsigned long>(max_parallelism, num_tasks_in_level);
-        }
-
-        return std::min<unsigned long>(max_parallelism, this->number_of_hosts);
-    }
-
-    std::tuple<double, double>
-    GlumeWMS::estimateWaitAndRunTimes(unsigned long start_level, unsigned long end_level,
-                                               unsigned long nodes) {
-        double runtime = WorkflowUtil::estimateMakespan(
-                this->getWorkflow()->getTasksInTopLevelRange(start_level, end_level),
-                nodes, this->core_speed);
-        double wait_time = this->proxyWMS->estimateWaitTime(nodes, runtime,
-                                                            this->simulation->getCurrentSimulatedDate(), &sequence);
-        return std::make_tuple(wait_time, runtime);
-    }
-
-    bool GlumeWMS::isTooWasteful(double runtime, unsigned long nodes, unsigned long start_level,
-                                          unsigned long end_level) {
-        double all_tasks_time = 0;
-        for (unsigned long i = start_level; i <= end_level; i++) {
-            all_tasks_time += WorkflowUtil::estimateMakespan(
-                    this->getWorkflow()->getTasksInTopLevelRange(i, i),
-                    1, this->core_speed);
+    /**
+     * @brief Evaluate splitting levels start_level-end_level into two consecutive jobs after a given level
+     * @param start_level: the first level
+     * @param split_level: the last level of the first job
+     * @param end_level: the last level
+     * @param parent_runtime: the time until the running parent job completes
+     * @param first_wait_time: the first job's wait time (output)
+     * @param first_runtime: the first job's requested execution time, with leeway (output)
+     * @param first_num_nodes: the first job's number of nodes (output)
+     * @return the makespan of the two jobs, or DBL_MAX if either needs too much leeway
+     */
+    double GlumeWMS::evaluateSplit(unsigned long start_level, unsigned long split_level, unsigned long end_level,
+                                   double parent_runtime, double *first_wait_time, double *first_runtime,
+                                   unsigned long *first_num_nodes) {
+        std::tuple<double, double, unsigned long> start_to_split = estimateJob(start_level, split_level, parent_runtime);
+        double wait_one = std::get<0>(start_to_split);
+        double run_one = std::get<1>(start_to_split);
+        unsigned long nodes_one = std::get<2>(start_to_split);
+
+        WRENCH_INFO("1: num nodes: %lu", std::get<2>(start_to_split));
+        WRENCH_INFO("1: wait_time: %lf", wait_one);
+        WRENCH_INFO("1: runtime: %lf", run_one);
+
+        // Calculate leeway needed for first group vs. currently running parent
+        double max_leeway_one = std::max<double>(0, (parent_runtime - wait_one));
+        double best_leeway_one = this->leeway_solver->findLeeway(run_one, nodes_one, parent_runtime, 0, max_leeway_one,
+                                                                 this->simulation->getCurrentSimulatedDate());
+
+        std::cout << "1: leeway needed: " << best_leeway_one << std::endl;
+
+        if (best_leeway_one > (run_one * .1)) {
+            std::cout << "Too much leeway needed - skipping group\n";
+            return DBL_MAX;
         }
 
-        double waste_ratio = (nodes * runtime - all_tasks_time) / (nodes * runtime);
-
-        return waste_ratio > this->waste_bound;
-    }
-
-    double
-    GlumeWMS::calculateLeewayBinarySearch(double runtime, unsigned long num_nodes, double parent_runtime,
-                                                   double lower,
-                                                   double upper) {
-        // std::cout << "LOWER: " << lower << " UPPER: " << upper << " greater? " << (lower >= upper) << std::endl;
-        assert(upper >= lower);
-
-        if ((upper - lower) < 600) {
-            return upper;
+        // Adjust the run and wait times for leeway
+        if (best_leeway_one > 0) {
+            run_one += best_leeway_one;
+            wait_one = this->proxyWMS->estimateWaitTime(nodes_one, run_one,
+                                                        this->simulation->getCurrentSimulatedDate(), &this->sequence);
+            std::cout << "1: recalculated wait_time: " << wait_one << std::endl;
+            std::cout << "1: recalculated runtime: " << run_one << std::endl;
         }
 
-        double middle = floor((lower + upper) / 2.0);
+        std::tuple<double, double, unsigned long> rest = estimateJob(split_level + 1, end_level, run_one);
+        double wait_two = std::get<0>(rest);
+        double run_two = std::get<1>(rest);
+        unsigned long nodes_two = std::get<2>(rest);
 
-        double new_wait_time = this->proxyWMS->estimateWaitTime(num_nodes, (runtime + middle),
-                                                                this->simulation->getCurrentSimulatedDate(), &sequence);
-        // std::cout << "NEW WAIT TIME: " << new_wait_time << std::endl;
-        double new_leeway = parent_runtime - new_wait_time;
+        std::cout << "2: num nodes: " << nodes_two << std::endl;
+        std::cout << "2: wait_time: " << wait_two << std::endl;
+        std::cout << "2: runtime: " << run_two << std::endl;
 
-        // not enough overlap :(
-        if (new_leeway >= 600) {
-            return calculateLeewayBinarySearch(runtime, num_nodes, parent_runtime, middle + 1, upper);
-        } else if (new_leeway < 0) {
-            return calculateLeewayBinarySearch(runtime, num_nodes, parent_runtime, lower, middle - 1);
-        }
-
-        // middle added was enough to create full overlap + (some slack < 10 minutes)
-        return middle;
-    }
+        // Calculate leeway needed for second group vs. first group ^
+        double max_leeway_two = std::max<double>(0, (run_one - wait_two));
+        double best_leeway_two = this->leeway_solver->findLeeway(run_two, nodes_two, run_one, 0, max_leeway_two,
+                                                                 this->simulation->getCurrentSimulatedDate());
 
-    void GlumeWMS::processEventPilotJobStart(std::shared_ptr<PilotJobStartedEvent> e) {
-        // Update queue waiting time
-        this->simulator->total_queue_wait_time +=
-                this->simulation->getCurrentSimulatedDate() - e->pilot_job->getSubmitDate();
+        std::cout << "2: leeway needed: " << best_leeway_two << std::endl;
 
-        WRENCH_INFO("Got a Pilot Job Start event: %s", e->pilot_job->getName().c_str());
-
-        if (this->pending_placeholder_job == nullptr) {
-            throw std::runtime_error("Fatal Error: couldn't find a placeholder job for a pilob job that just started");
+        if (best_leeway_two > (run_two * .1)) {
+            std::cout << "Too much leeway needed for grouping\n";
+            return DBL_MAX;
         }
 
-        WRENCH_INFO("Got a Pilot Job Start event e->pilot_job = %ld, this->pending->pilot_job = %ld (%s)",
-                    (unsigned long) e->pilot_job.get(),
-                    (unsigned long) this->pending_placeholder_job->pilot_job.get(),
-                    this->pending_placeholder_job->pilot_job->getName().c_str());
-
-        if (e->pilot_job != this->pending_placeholder_job->pilot_job) {
-            // hmm
-            WRENCH_INFO("Must be for a placeholder I already cancelled... nevermind");
-            return;
+        // Adjust the run and wait times for leeway
+        if (best_leeway_two > 0) {
+            run_two += best_leeway_two;
+            wait_two = this->proxyWMS->estimateWaitTime(nodes_two, run_two,
+                                                        this->simulation->getCurrentSimulatedDate(), &this->sequence);
+            std::cout << "2: recalculated wait_time: " << wait_two << std::endl;
+            std::cout << "2: recalculated runtime: " << run_two << std::endl;
         }
 
-        PlaceHolderJob *placeholder_job = this->pending_placeholder_job;
-        this->running_placeholder_jobs.insert(placeholder_job);
-        this->pending_placeholder_job = nullptr;
-
-        // std::string output_string = "";
+        double makespan = wait_one + std::max<double>(run_one, wait_two) + run_two;
 
-        for (auto task : placeholder_job->tasks) {
-            if (task->getState() == WorkflowTask::State::READY  and (placeholder_job->num_standard_job_submitted < placeholder_job->num_hosts)) {
-                auto standard_job = this->job_manager->createStandardJob(task, {});
+        std::cout << "makespan: " << makespan << std::endl;
 
-                // output_string += " " + task->getID();
-
-                WRENCH_INFO("Submitting task %s as part of placeholder job %ld-%ld",
-                            task->getID().c_str(), placeholder_job->start_level, placeholder_job->end_level);
-                this->job_manager->submitJob(standard_job, placeholder_job->pilot_job->getComputeService());
-                placeholder_job->num_standard_job_submitted++;
-            }
-        }
-
-        this->applyGroupingHeuristic();
+        *first_wait_time = wait_one;
+        *first_runtime = run_one;
+        *first_num_nodes = nodes_one;
+        return makespan;
     }
 
-    void GlumeWMS::processEventPilotJobExpiration(std::shared_ptr<PilotJobExpiredEvent> e) {
-        PlaceHolderJob *placeholder_job = nullptr;
-        for (auto ph : this->running_placeholder_jobs) {
-            if (ph->pilot_job == e->pilot_job) {
-                placeholder_job = ph;
-                break;
-            }
-        }
-
-        if (placeholder_job == nullptr) {
-            throw std::runtime_error("Got a pilot job expiration, but no matching placeholder job found");
-        }
-
-        this->running_placeholder_jobs.erase(placeholder_job);
-
-        WRENCH_INFO("Got a pilot job expiration for a placeholder job that deals with levels %ld-%ld (%s)",
-                    placeholder_job->start_level, placeholder_job->end_level,
-                    placeholder_job->pilot_job->getName().c_str());
-
-        // Check if there are unprocessed tasks
-        bool unprocessed = false;
-        for (auto t : placeholder_job->tasks) {
-            if (t->getState() != WorkflowTask::COMPLETED) {
-                unprocessed = true;
-                break;
-            }
-        }
-
-        unsigned long num_used_nodes;
-        sscanf(e->pilot_job->getServiceSpecificArguments()["-N"].c_str(), "%lu", &num_used_nodes);
-
-        unsigned long num_used_minutes;
-        sscanf(e->pilot_job->getServiceSpecificArguments()["-t"].c_str(), "%lu", &num_used_minutes);
-
-        double wasted_node_seconds = 60.0 * num_used_minutes * num_used_nodes;
-
-        for (auto t : placeholder_job->tasks) {
-            if (t->getState() == WorkflowTask::State::COMPLETED) {
-                wasted_node_seconds -= t->getFlops() / this->core_speed;
-            }
-        }
-        this->simulator->wasted_node_seconds += wasted_node_seconds;
-
-        if (not unprocessed) {
-            // Nothing to do
-            WRENCH_INFO("This placeholder job has no unprocessed tasks. great.");
-            return;
-        }
-
-        this->simulator->num_pilot_job_expirations_with_remaining_tasks_to_do++;
+    // Return params: (wait time, runtime, num_hosts)
+    std::tuple<double, double, unsigned long>
+    GlumeWMS::estimateJob(unsigned long start_level, unsigned long end_level, double delay) {
+        QueryProfiler::Phase phase("parallelism");
 
-        WRENCH_INFO("This placeholder job has unprocessed tasks");
+        double runtime = DBL_MAX;
+        double wait_time = DBL_MAX;
+        double best_makespan = DBL_MAX;
+        unsigned long best_parallelism = 1;
 
-        if (this->pending_placeholder_job) {
-            // Cancel pending pilot job if any
-            WRENCH_INFO("Canceling pending placeholder job (placeholder=%ld,  pilot_job=%ld / %s",
-                        (unsigned long) this->pending_placeholder_job,
-                        (unsigned long) this->pending_placeholder_job->pilot_job.get(),
-                        this->pending_placeholder_job->pilot_job->getName().c_str());
-            this->job_manager->terminateJob(this->pending_placeholder_job->pilot_job);
-            this->pending_placeholder_job = nullptr;
-        }
+        unsigned long max_parallelism = findMaxParallelism(start_level, end_level);
 
-        // Cancel running pilot jobs if none of their tasks has started
+        std::vector<double> runtimes = WorkflowUtil::estimateMakespanCurve(
+                *WorkflowUtil::getDagSnapshot(this->getWorkflow()), start_level, end_level,
+                max_parallelism, this->core_speed);
 
-        std::set<PlaceHolderJob *> to_remove;
-        for (auto ph : this->running_placeholder_jobs) {
-            bool started = false;
-            for (auto task : ph->tasks) {
-                if (task->getState() != WorkflowTask::State::NOT_READY) {
-                    started = true;
-                }
-            }
-            if (not started) {
-                // hmm
-                WRENCH_INFO("Canceling running placeholder job that handled levels %ld-%ld because none"
-                            "of its tasks has started (%s)", ph->start_level, ph->end_level,
-                            ph->pilot_job->getName().c_str());
-                try {
-                    this->job_manager->terminateJob(ph->pilot_job);
-                } catch (WorkflowExecutionException &e) {
-                    // ignore (likely already dead!)
-                }
-                to_remove.insert(ph);
+        // Get the wait times of all node counts that are not too wasteful in one request
+        std::vector<std::pair<unsigned long, double>> configurations;
+        for (unsigned long i = 1; i <= max_parallelism; i++) {
+            if (not isTooWasteful(runtimes[i - 1], i, start_level, end_level)) {
+                configurations.push_back(std::make_pair(i, runtimes[i - 1]));
             }
         }
-
-        for (auto ph : to_remove) {
-            this->running_placeholder_jobs.erase(ph);
-        }
-
-        this->applyGroupingHeuristic();
-    }
-
-    void GlumeWMS::processEventStandardJobCompletion(std::shared_ptr<StandardJobCompletedEvent> e) {
-        // only one task per job
-        WorkflowTask *completed_task = e->standard_job->tasks[0];
-
-        WRENCH_INFO("Got a standard job completion for task %s", completed_task->getID().c_str());
-
-        this->simulator->used_node_seconds += completed_task->getFlops() / this->core_speed;
-
-        // Find the placeholder job this task belongs to
-        PlaceHolderJob *placeholder_job = nullptr;
-        for (auto ph : this->running_placeholder_jobs) {
-            for (auto task : ph->tasks) {
-                if (task == completed_task) {
-                    placeholder_job = ph;
-                    break;
-                }
-            }
+        if (configurations.empty()) {
+            // Never leave the job without a number of nodes
+            configurations.push_back(std::make_pair(1, runtimes[0]));
         }
+        std::vector<double> wait_times = this->proxyWMS->estimateWaitTimes(
+                configurations, this->simulation->getCurrentSimulatedDate(), &this->sequence);
 
-        if (placeholder_job != nullptr) {
+        for (unsigned long k = 0; k < configurations.size(); k++) {
+            unsigned long i = configurations[k].first;
+            double curr_runtime = configurations[k].second;
+            double curr_wait = wait_times[k];
 
-            placeholder_job->num_standard_job_submitted--;
-
-            // Terminate the pilot job in case all its tasks are done
-            bool all_tasks_done = true;
-            for (auto t : placeholder_job->tasks) {
-                if (t->getState() != WorkflowTask::COMPLETED) {
-                    all_tasks_done = false;
-                    break;
-                }
-            }
-            if (all_tasks_done) {
-                // Update the wasted no seconds metric
-                double first_task_start_time = DBL_MAX;
-                for (auto const &t : placeholder_job->tasks) {
-                    if (t->getStartDate() < first_task_start_time) {
-                        first_task_start_time = t->getStartDate();
-                    }
-                }
-                int num_requested_nodes = stoi(placeholder_job->pilot_job->getServiceSpecificArguments()["-N"]);
-                double job_duration = this->simulation->getCurrentSimulatedDate() - first_task_start_time;
-                double wasted_node_seconds = num_requested_nodes * job_duration;
-                for (auto const &t : placeholder_job->tasks) {
-                    wasted_node_seconds -= t->getFlops() / this->core_speed;
-                }
-
-                this->simulator->wasted_node_seconds += wasted_node_seconds;
+            double curr_makespan = std::max<double>(delay, curr_wait) + curr_runtime;
 
-                WRENCH_INFO("All tasks are completed in this placeholder job, so I am terminating it (%s)",
-                            placeholder_job->pilot_job->getName().c_str());
-                try {
-                    // hmm
-                    WRENCH_INFO("TERMINATING A PILOT JOB");
-                    this->job_manager->terminateJob(placeholder_job->pilot_job);
-                } catch (WorkflowExecutionException &e) {
-                    // ignore
-                }
-                this->running_placeholder_jobs.erase(placeholder_job);
+            if (curr_makespan <= best_makespan) {
+                runtime = curr_runtime;
+                wait_time = curr_wait;
+                best_makespan = curr_makespan;
+                best_parallelism = i;
             }
         }
 
-        // Start all newly ready tasks that depended on the completed task, IN ANY PLACEHOLDER
-        std::vector<WorkflowTask *> children = this->getWorkflow()->getTaskChildren(completed_task);
-        for (auto ph : this->running_placeholder_jobs) {
-
-            // Start Other tasks if possible, considering first tasks at the same level of completed_task
-            for (auto task : ph->tasks) {
-                if ((task->getState() == WorkflowTask::READY) and
-                (task->getTopLevel() == completed_task->getTopLevel()) and
-                (ph->num_standard_job_submitted < ph->num_hosts)) {
-
-                    auto standard_job = this->job_manager->createStandardJob(task, {});
-                    // hmm
-                    WRENCH_INFO("Submitting task %s  as part of placeholder job %ld-%ld",
-                                task->getID().c_str(), placeholder_job->start_level, placeholder_job->end_level);
-                    this->job_manager->submitJob(standard_job, ph->pilot_job->getComputeService());
-
-                    ph->num_standard_job_submitted++;
-                }
-            }
-
-            // Start Any other READY TASKS if possible
-            for (auto task : ph->tasks) {
-                if ((task->getState() == WorkflowTask::READY) and (ph->num_standard_job_submitted < ph->num_hosts)) {
-
-                        auto standard_job = this->job_manager->createStandardJob(task, {});
-                        // hmm
-                        WRENCH_INFO("Submitting task %s  as part of placeholder job %ld-%ld",
-                                    task->getID().c_str(), placeholder_job->start_level, placeholder_job->end_level);
-                        this->job_manager->submitJob(standard_job, ph->pilot_job->getComputeService());
-
-                        ph->num_standard_job_submitted++;
-
-                }
-            }
-        }
-    }
+        assert(runtime != DBL_MAX && wait_time != DBL_MAX);
 
-    void GlumeWMS::processEventStandardJobFailure(std::shared_ptr<StandardJobFailedEvent> e) {
-        WRENCH_INFO("Got a standard job failure event for task %s -- IGNORING THIS",
-                    e->standard_job->tasks[0]->getID().c_str());
-        throw std::runtime_error("A job has failed, which shouldn't happen");
+        return std::make_tuple(wait_time, runtime, best_parallelism);
     }
 
-
 };
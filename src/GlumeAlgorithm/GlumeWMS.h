@@ -12,65 +12,36 @@
 #define YOUR_PROJECT_NAME_GLUMEWMS_H
 
 
-#include <wrench-dev.h>
-#include "Simulator.h"
-#include <Util/PlaceHolderJob.h>
-#include <Util/ProxyWMS.h>
+#include <Util/LevelGroupingWMS.h>
 
 namespace wrench {
 
-    class GlumeWMS : public WMS {
+    class GlumeWMS : public LevelGroupingWMS {
 
     public:
 
         GlumeWMS(Simulator *simulator, std::string hostname, double waste_bound, double beat_bound,
-                          std::shared_ptr<BatchComputeService> batch_service);
+                 bool use_wait_time_surface, std::shared_ptr<BatchComputeService> batch_service);
 
     private:
 
-        std::shared_ptr<BatchComputeService> batch_service;
+        void applyGroupingHeuristic() override;
 
-        int main() override;
+        void reportStatistics() override;
 
-        void applyGroupingHeuristic();
+        double evaluateSplit(unsigned long start_level, unsigned long split_level, unsigned long end_level,
+                             double parent_runtime, double *first_wait_time, double *first_runtime,
+                             unsigned long *first_num_nodes);
 
         std::tuple<double, double, unsigned long>
         estimateJob(unsigned long start_level, unsigned long end_level, double delay);
 
-        unsigned long findMaxParallelism(unsigned long start_level, unsigned long end_level);
-
-        std::tuple<double, double>
-        estimateWaitAndRunTimes(unsigned long start_level, unsigned long end_level, unsigned long nodes);
-
-        bool isTooWasteful(double runtime, unsigned long nodes, unsigned long start_level,
-                                              unsigned long end_level);
-
-        double calculateLeewayBinarySearch(double runtime, unsigned long num_nodes, double parent_runtime, double lower,
-                                           double upper);
-
-        void processEventPilotJobStart(std::shared_ptr<PilotJobStartedEvent> e) override;
-
-        void processEventPilotJobExpiration(std::shared_ptr<PilotJobExpiredEvent> e) override;
-
-        void processEventStandardJobCompletion(std::shared_ptr<StandardJobCompletedEvent> e) override;
-
-        void processEventStandardJobFailure(std::shared_ptr<StandardJobFailedEvent> e) override;
-
-        Simulator *simulator;
-
-        double waste_bound;
         double beat_bound;
 
-        std::set<PlaceHolderJob *> running_placeholder_jobs;
-        PlaceHolderJob *pending_placeholder_job;
-        double core_speed;
-        unsigned long number_of_hosts;
-        std::shared_ptr<JobManager> job_manager;
-
-        ProxyWMS *proxyWMS;
-
-        unsigned long number_of_splits;
-    };
+        // Number of candidate splits, and number of them that the split search evaluated
+        unsigned long num_split_candidates;
+        unsigned long num_split_evaluations;
+};
 
 };
 
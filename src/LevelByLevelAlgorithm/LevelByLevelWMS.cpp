@@ -14,6 +14,8 @@
 #include <managers/JobManager.h>
 #include <StaticClusteringAlgorithms/ClusteredJob.h>
 #include <StaticClusteringAlgorithms/StaticClusteringWMS.h>
+#include <Util/ProxyWMS.h>
+#include <Util/LeewaySolver.h>
 #include "Simulator.h"
 #include "LevelByLevelWMS.h"
 #include "OngoingLevel.h"
@@ -24,6 +26,8 @@ typedef unsigned long ulong;
 
 namespace wrench {
 
+    static int sequence = 0;
+
     LevelByLevelWMS::LevelByLevelWMS(Simulator *simulator, std::string hostname, bool overlap,
                                      std::string clustering_spec,
                                      std::shared_ptr<BatchComputeService> batch_service) :
@@ -32,9 +36,6 @@ namespace wrench {
         this->overlap = overlap;
         this->batch_service = batch_service;
         this->clustering_spec = clustering_spec;
-
-        // TODO - Overlapping is broken due to leeway issues
-        assert(not this->overlap);
     }
 
 
@@ -52,12 +53,19 @@ namespace wrench {
         // Create a job manager
         this->job_manager = this->createJobManager();
 
+        // Used to pick the leeway of overlapping levels
+        this->proxyWMS = new ProxyWMS(this->getWorkflow(), this->job_manager, this->batch_service,
+                                      this->simulator->wait_time_predictor);
+        this->leeway_solver = new LeewaySolver(this->proxyWMS, &sequence);
+
         while (not this->getWorkflow()->isDone()) {
 
             submitPilotJobsForNextLevel();
 
             this->waitForAndProcessNextEvent();
 
+            // The event may have changed the batch queue
+            this->proxyWMS->clearStartTimeEstimates();
         }
 
         return 0;
@@ -81,12 +89,13 @@ namespace wrench {
 
         // TODO - next level to submit? What if incomplete tasks?
 
-        // Compute which level should be submitted
+        // Compute which level should be submitted: the one after the last level completed or submitted
+        // (ULONG_MAX: no level completed or submitted yet)
         ulong level_to_submit = this->last_level_completed;
 
         for (auto l : this->ongoing_levels) {
             ulong level_number = l.second->level_number;
-            if (level_to_submit < level_number) {
+            if ((level_to_submit == ULONG_MAX) or (level_to_submit < level_number)) {
                 level_to_submit = level_number;
             }
         }
@@ -107,7 +116,9 @@ namespace wrench {
         }
 
         // Make sure that all PH jobs in the previous level have started
-        if (level_to_submit > 0 and (this->ongoing_levels.find(level_to_submit) != this->ongoing_levels.end())) {
+        OngoingLevel *previous_level = nullptr;
+        if (level_to_submit > 0 and (this->ongoing_levels.find(level_to_submit - 1) != this->ongoing_levels.end())) {
+            previous_level = this->ongoing_levels[level_to_submit - 1];
             if (not(this->ongoing_levels[level_to_submit - 1]->pending_placeholder_jobs.empty())) {
 
                 WRENCH_INFO(
@@ -141,7 +152,6 @@ namespace wrench {
 
         placeholder_jobs = createPlaceHolderJobsForLevel(level_to_submit);
 
-        // TODO - Must calculate leeway
         // Submit placeholder jobs
         for (auto ph : placeholder_jobs) {
             new_ongoing_level->pending_placeholder_jobs.insert(ph);
@@ -149,6 +159,12 @@ namespace wrench {
             // Create the pilot job
             double makespan = ph->clustered_job->estimateMakespan(this->core_speed) * EXECUTION_TIME_FUDGE_FACTOR;
 
+            // If the previous level is still running, ask for enough extra time to not expire while
+            // waiting for it in case the pilot job starts before it is done
+            if (previous_level != nullptr) {
+                makespan += calculateLeeway(ph, makespan, previous_level);
+            }
+
             // Create the pilot job
             ph->pilot_job = this->job_manager->createPilotJob();
 
@@ -159,6 +175,10 @@ namespace wrench {
             service_specific_args["-t"] = std::to_string(1 + ((ulong) (makespan) / 60));
             this->job_manager->submitJob(ph->pilot_job, this->batch_service,
                                          service_specific_args);
+            this->placeholder_registry.add(ph, new_ongoing_level);
+            this->simulator->wait_time_predictor->notifyJobSubmission(
+                    ph->pilot_job.get(), ph->clustered_job->getNumNodes(),
+                    60.0 * std::stoul(service_specific_args["-t"]));
 
             WRENCH_INFO("Submitted a Pilot Job (%s hosts, %s min) for workflow level %lu (%s)",
                         service_specific_args["-N"].c_str(),
@@ -228,7 +248,7 @@ namespace wrench {
                 // std::cout << "num tasks in job: " << job->getNumTasks() << std::endl;
                 ulong num_nodes = job->computeBestNumNodesBasedOnQueueWaitTimePredictions(
                         std::min<ulong>(job->getNumTasks(), this->number_of_nodes), this->core_speed,
-                        this->batch_service);
+                        this->simulator->wait_time_predictor);
                 job->setNumNodes(num_nodes, true);
             }
 
@@ -364,6 +384,57 @@ namespace wrench {
         return place_holder_jobs;
     }
 
+    /**
+     * @brief Find the leeway with which a placeholder job, submitted now, would start about when the
+     *        still-running previous level completes
+     * @param placeholder_job: the placeholder job
+     * @param runtime: the placeholder job's requested execution time, without leeway
+     * @param previous_level: the previous level
+     * @return a leeway, in seconds
+     */
+    double LevelByLevelWMS::calculateLeeway(PlaceHolderJob *placeholder_job, double runtime,
+                                            OngoingLevel *previous_level) {
+        double parent_runtime = ProxyWMS::findMaxDuration(previous_level->running_placeholder_jobs);
+        unsigned long num_nodes = placeholder_job->clustered_job->getNumNodes();
+        double wait_time = this->proxyWMS->estimateWaitTime(num_nodes, runtime,
+                                                            this->simulation->getCurrentSimulatedDate(), &sequence);
+        double leeway = parent_runtime - wait_time;
+        if (leeway <= 0) {
+            return 0;
+        }
+
+        leeway = this->leeway_solver->findLeeway(runtime, num_nodes, parent_runtime, 0, leeway,
+                                                 this->simulation->getCurrentSimulatedDate());
+
+        WRENCH_INFO("Leeway for a placeholder job of level %lu: %lf (wait time: %lf, previous level runtime: %lf)",
+                    placeholder_job->start_level, leeway, wait_time, parent_runtime);
+
+        return leeway;
+    }
+
+    /**
+     * @brief Submit, each in its own standard job, the tasks of a running placeholder job whose parents
+     *        have all completed
+     * @param placeholder_job: the placeholder job
+     */
+    void LevelByLevelWMS::submitReadyTasks(PlaceHolderJob *placeholder_job) {
+        while (true) {
+            WorkflowTask *task = placeholder_job->popReadyTask();
+            if (task == nullptr) {
+                break;
+            }
+            if (task->getState() != WorkflowTask::READY) {
+                // Already submitted
+                continue;
+            }
+            auto standard_job = this->job_manager->createStandardJob(task, {});
+
+            WRENCH_INFO("Submitting task %s as part of placeholder job %ld-%ld",
+                        task->getID().c_str(), placeholder_job->start_level, placeholder_job->end_level);
+            this->job_manager->submitJob(standard_job, placeholder_job->pilot_job->getComputeService());
+        }
+    }
+
 
     void LevelByLevelWMS::processEventPilotJobStart(std::shared_ptr<PilotJobStartedEvent> e) {
         // Just for kicks, check it was the pending one
@@ -376,19 +447,12 @@ namespace wrench {
                 this->simulation->getCurrentSimulatedDate() - e->pilot_job->getSubmitDate();
 
         // Find the placeholder job in the pending list
-        PlaceHolderJob *placeholder_job = nullptr;
-        OngoingLevel *ongoing_level = nullptr;
-        for (auto ol : this->ongoing_levels) {
-            for (auto ph : ol.second->pending_placeholder_jobs) {
-                if (ph->pilot_job == e->pilot_job) {
-                    placeholder_job = ph;
-                    ongoing_level = ol.second;
-                    break;
-                }
-            }
-        }
+        PlaceHolderJob *placeholder_job = this->placeholder_registry.getPlaceholderJob(e->pilot_job.get());
+        OngoingLevel *ongoing_level = this->placeholder_registry.getOngoingLevel(placeholder_job);
 
-        if (placeholder_job == nullptr) {
+        if ((placeholder_job == nullptr) or
+            (ongoing_level->pending_placeholder_jobs.find(placeholder_job) ==
+             ongoing_level->pending_placeholder_jobs.end())) {
             throw std::runtime_error("Fatal Error: couldn't find a placeholder job for a pilot job that just started");
         }
 
@@ -402,19 +466,10 @@ namespace wrench {
         ongoing_level->pending_placeholder_jobs.erase(placeholder_job);
         ongoing_level->running_placeholder_jobs.insert(placeholder_job);
 
-        // Submit all ready tasks to it each in its standard job
-        std::string output_string = "";
-        for (auto task : placeholder_job->clustered_job->getTasks()) {
-            if (task->getState() == WorkflowTask::READY) {
-                auto standard_job = this->job_manager->createStandardJob(task, {});
-                output_string += " " + task->getID();
-
-                WRENCH_INFO("Submitting task %s as part of placeholder job %ld-%ld",
-                            task->getID().c_str(), placeholder_job->start_level, placeholder_job->end_level);
-                this->job_manager->submitJob(standard_job, placeholder_job->pilot_job->getComputeService());
-            } else { WRENCH_INFO("Task %s is not ready", task->getID().c_str());
-            }
-        }
+        // Submit all ready tasks to it each in its standard job (with overlap, it may have started before
+        // the previous level is done, in which case the others are submitted as their parents complete)
+        placeholder_job->initializeReadyQueue(this->getWorkflow(), this->placeholder_registry.getCompletedTasks());
+        this->submitReadyTasks(placeholder_job);
 
     }
 
@@ -423,25 +478,18 @@ namespace wrench {
 
 //        std::cout << "GOT AN EXPIRATION" << std::endl;
 
-        // Find the placeholder job
-        // Find the placeholder job in the pending list
-        PlaceHolderJob *placeholder_job = nullptr;
-        OngoingLevel *ongoing_level = nullptr;
-
-        for (auto ol : this->ongoing_levels) {
-            for (auto ph : ol.second->running_placeholder_jobs) {
-                if (ph->pilot_job == e->pilot_job) {
-                    placeholder_job = ph;
-                    ongoing_level = ol.second;
-                    break;
-                }
-            }
-        }
+        // Find the placeholder job in the running list
+        PlaceHolderJob *placeholder_job = this->placeholder_registry.getPlaceholderJob(e->pilot_job.get());
+        OngoingLevel *ongoing_level = this->placeholder_registry.getOngoingLevel(placeholder_job);
 
-        if (placeholder_job == nullptr) {
+        if ((placeholder_job == nullptr) or
+            (ongoing_level->running_placeholder_jobs.find(placeholder_job) ==
+             ongoing_level->running_placeholder_jobs.end())) {
             throw std::runtime_error("Got a pilot job expiration, but no matching placeholder job found");
         }
 
+        this->proxyWMS->notifyJobTermination(e->pilot_job.get());
+
         WRENCH_INFO("Got a pilot job expiration for a placeholder job that deals with levels %ld-%ld (%s)",
                     placeholder_job->start_level, placeholder_job->end_level,
                     placeholder_job->pilot_job->getName().c_str());
@@ -476,25 +524,18 @@ namespace wrench {
 
         this->simulator->wasted_node_seconds += wasted_node_seconds;
 
+        ongoing_level->running_placeholder_jobs.erase(placeholder_job);
+        this->placeholder_registry.remove(placeholder_job);
+
         if (not unprocessed) { // Nothing to do
             WRENCH_INFO("This placeholder job has no unprocessed tasks. great.");
+            ongoing_level->completed_placeholder_jobs.insert(placeholder_job);
+            this->removeOngoingLevelIfFinished(ongoing_level);
             return;
         }
 
-        // TODO - this will break for all algorithms except OJ!
-//        std::cout << "Removing level of expired job from ongoing_levels" << std::endl;
-
-        this->ongoing_levels.erase((int) ongoing_level->level_number);
-
         this->simulator->num_pilot_job_expirations_with_remaining_tasks_to_do++;
 
-        return;
-
-        // TODO - Let grouping heuristic process expired tasks in level...
-
-
-        ongoing_level->running_placeholder_jobs.erase(placeholder_job);
-
         WRENCH_INFO("This placeholder job has unprocessed tasks... resubmit it as a restart");
         // Create a new Clustered Job
         ClusteredJob *cj = new ClusteredJob();
@@ -508,13 +549,36 @@ namespace wrench {
             // Don't be stupid, don't ask for more nodes than tasks
             cj->setNumNodes(std::min(placeholder_job->clustered_job->getNumNodes(), cj->getNumTasks()));
         } else {
-            ulong num_nodes = cj->computeBestNumNodesBasedOnQueueWaitTimePredictions(cj->getNumTasks(),
-                                                                                     this->core_speed,
-                                                                                     this->batch_service);
+            ulong num_nodes = cj->computeBestNumNodesBasedOnQueueWaitTimePredictions(
+                    std::min<ulong>(cj->getNumTasks(), this->number_of_nodes), this->core_speed,
+                    this->simulator->wait_time_predictor);
             cj->setNumNodes(num_nodes, true);
         }
 
-        double makespan = cj->estimateMakespan(this->core_speed) * EXECUTION_TIME_FUDGE_FACTOR;
+        // The expired job's completed tasks took longer than estimated (e.g., because the pilot job's
+        // hosts were not all busy), so scale the estimate of the remaining tasks by the observed ratio
+        // between the time it took to complete them and their estimated share of its makespan
+        double observed_ratio = 1.0;
+        if (used_seconds > 0) {
+            double total_seconds = 0;
+            double first_task_start_time = DBL_MAX;
+            for (auto t : placeholder_job->clustered_job->getTasks()) {
+                total_seconds += t->getFlops() / this->core_speed;
+                if (t->getState() == WorkflowTask::COMPLETED) {
+                    first_task_start_time = std::min<double>(first_task_start_time, t->getStartDate());
+                }
+            }
+            double estimated_seconds = placeholder_job->clustered_job->estimateMakespan(this->core_speed) *
+                                       (used_seconds / total_seconds);
+            double observed_seconds = this->simulation->getCurrentSimulatedDate() - first_task_start_time;
+            if (estimated_seconds > 0) {
+                observed_ratio = std::max<double>(1.0, observed_seconds / estimated_seconds);
+            }
+        }
+
+        double makespan = cj->estimateMakespan(this->core_speed) * observed_ratio * EXECUTION_TIME_FUDGE_FACTOR;
+
+        WRENCH_INFO("Observed/estimated execution time ratio of the expired placeholder job: %lf", observed_ratio);
 
         // Create the pilot job
         auto pj = this->job_manager->createPilotJob();
@@ -523,6 +587,13 @@ namespace wrench {
                 new PlaceHolderJob(pj, cj,
                                    ongoing_level->level_number, ongoing_level->level_number);
 
+        // With overlap, the previous level may still be running
+        if ((ongoing_level->level_number > 0) and
+            (this->ongoing_levels.find(ongoing_level->level_number - 1) != this->ongoing_levels.end())) {
+            makespan += calculateLeeway(replacement_placeholder_job, makespan,
+                                        this->ongoing_levels[ongoing_level->level_number - 1]);
+        }
+
         // Resubmit it!
         ongoing_level->pending_placeholder_jobs.insert(replacement_placeholder_job);
         // submit the corresponding pilot job
@@ -531,18 +602,24 @@ namespace wrench {
         service_specific_args["-c"] = std::to_string(1);
         service_specific_args["-t"] = std::to_string(1 + ((ulong) (makespan)) / 60);
         this->job_manager->submitJob(replacement_placeholder_job->pilot_job, this->batch_service,
-                                     service_specific_args);WRENCH_INFO(
-                "Submitted a Pilot Job (%s hosts, %s min) for workflow level %lu (%s)",
-                service_specific_args["-N"].c_str(),
-                service_specific_args["-t"].c_str(),
-                ongoing_level->level_number,
-                replacement_placeholder_job->pilot_job->getName().c_str());WRENCH_INFO(
-                "This pilot job has these tasks:");
-        for (auto t : replacement_placeholder_job->clustered_job->getTasks()) { WRENCH_INFO("     - %s (flops: %lf)",
-                                                                                            t->getID().c_str(),
-                                                                                            t->getFlops());
-        }
+                                     service_specific_args);
+        this->placeholder_registry.add(replacement_placeholder_job, ongoing_level);
+        this->simulator->wait_time_predictor->notifyJobSubmission(
+                replacement_placeholder_job->pilot_job.get(), cj->getNumNodes(),
+                60.0 * std::stoul(service_specific_args["-t"]));
+
+        WRENCH_INFO("Submitted a Pilot Job (%s hosts, %s min) for workflow level %lu (%s)",
+                    service_specific_args["-N"].c_str(),
+                    service_specific_args["-t"].c_str(),
+                    ongoing_level->level_number,
+                    replacement_placeholder_job->pilot_job->getName().c_str());
+
+        WRENCH_INFO("This pilot job has these tasks:");
 
+        for (auto t : replacement_placeholder_job->clustered_job->getTasks()) {
+
+            WRENCH_INFO("     - %s (flops: %lf)", t->getID().c_str(), t->getFlops());
+        }
     }
 
 
@@ -555,25 +632,19 @@ namespace wrench {
         this->simulator->used_node_seconds += completed_task->getFlops() / this->core_speed;
 
         // Find the placeholder job this task belongs to
-        PlaceHolderJob *placeholder_job = nullptr;
-        OngoingLevel *ongoing_level = nullptr;
-        for (auto ol : this->ongoing_levels) {
-            for (auto ph : ol.second->running_placeholder_jobs) {
-                for (auto task : ph->clustered_job->getTasks()) {
-                    if (task == completed_task) {
-                        ongoing_level = ol.second;
-                        placeholder_job = ph;
-                        break;
-                    }
-                }
-            }
-        }
+        PlaceHolderJob *placeholder_job = this->placeholder_registry.getPlaceholderJob(completed_task);
+        OngoingLevel *ongoing_level = this->placeholder_registry.getOngoingLevel(placeholder_job);
 
-        if (placeholder_job == nullptr) {
+        if ((placeholder_job == nullptr) or
+            (ongoing_level->running_placeholder_jobs.find(placeholder_job) ==
+             ongoing_level->running_placeholder_jobs.end())) {
             throw std::runtime_error("Got a task completion, but couldn't find a placeholder for the task, "
                                      "and we're not in individual mode");
         }
 
+        // Queue the tasks, in running placeholder jobs, whose last uncompleted parent was the completed task
+        this->placeholder_registry.notifyTaskCompletion(completed_task, this->getWorkflow());
+
         // Terminate the pilot job in case all its tasks are done
         bool all_tasks_done = true;
         for (auto task : placeholder_job->clustered_job->getTasks()) {
@@ -603,49 +674,47 @@ namespace wrench {
             WRENCH_INFO("All tasks are completed in this placeholder job, so I am terminating it (%s)",
                         placeholder_job->pilot_job->getName().c_str());
             try {
-                this->job_manager->terminateJob(placeholder_job->pilot_job);
+                this->proxyWMS->terminateJob(placeholder_job->pilot_job);
             } catch (WorkflowExecutionException &e) {
                 // ignore
             }
             ongoing_level->running_placeholder_jobs.erase(placeholder_job);
             ongoing_level->completed_placeholder_jobs.insert(placeholder_job);
-            // TODO - this isn't removing from this->ongoing_levels???
+            this->placeholder_registry.remove(placeholder_job);
 //            std::cout << "Finished all jobs in a placeholder!" << std::endl;
         }
 
-        /**
-        // Start all newly ready tasks that depended on the completed task, IN ANY PLACEHOLDER
-        // This shouldn't happen in individual mode, but can't hurt
-        WRENCH_INFO("Seeing if other tasks (which are now ready) can be submitted...");
-        std::vector<WorkflowTask *> children = this->getWorkflow()->getTaskChildren(completed_task);
+        // Start all newly ready tasks that depended on the completed task, IN ANY PLACEHOLDER (with
+        // overlap, those of the next level)
         for (auto ol : this->ongoing_levels) {
             for (auto ph : ol.second->running_placeholder_jobs) {
-
-                for (auto task : ph->clustered_job->getTasks()) {
-                    if ((std::find(children.begin(), children.end(), task) != children.end()) and
-                        (task->getState() == WorkflowTask::READY)) {
-                        StandardJob *standard_job = this->job_manager->createStandardJob(task, {});WRENCH_INFO(
-                                "Submitting task %s  as part of placeholder job %ld-%ld",
-                                task->getID().c_str(), ph->start_level, ph->end_level);
-                        this->job_manager->submitJob(standard_job, ph->pilot_job->getComputeService());
-                    }
-                }
+                this->submitReadyTasks(ph);
             }
         }
-        */
 
         // Remove the ongoing level if it's finished
-        if (ongoing_level->pending_placeholder_jobs.empty() and
-            ongoing_level->running_placeholder_jobs.empty()) {
+        this->removeOngoingLevelIfFinished(ongoing_level);
+    }
 
-            WRENCH_INFO("Level %ld is finished!", ongoing_level->level_number);
+    /**
+     * @brief Remove an ongoing level if none of its placeholder jobs is pending or running
+     * @param ongoing_level: the ongoing level
+     */
+    void LevelByLevelWMS::removeOngoingLevelIfFinished(OngoingLevel *ongoing_level) {
+        if (not(ongoing_level->pending_placeholder_jobs.empty() and
+                ongoing_level->running_placeholder_jobs.empty())) {
+            return;
+        }
 
-//            printf("Level %ld is finished!\n", ongoing_level->level_number);
-            this->last_level_completed = ongoing_level->level_number;
+        WRENCH_INFO("Level %ld is finished!", ongoing_level->level_number);
 
-            this->ongoing_levels.erase(ongoing_level->level_number);
+        // With overlap, the next level may have finished first
+        if ((this->last_level_completed == ULONG_MAX) or
+            (this->last_level_completed < ongoing_level->level_number)) {
+            this->last_level_completed = ongoing_level->level_number;
         }
 
+        this->ongoing_levels.erase(ongoing_level->level_number);
     }
 
     void LevelByLevelWMS::processEventStandardJobFailure(std::shared_ptr<StandardJobFailedEvent> e) {
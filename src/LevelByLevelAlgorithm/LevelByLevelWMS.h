@@ -12,6 +12,7 @@
 
 
 #include <services/compute/batch/BatchComputeService.h>
+#include <Util/PlaceholderRegistry.h>
 
 namespace wrench {
 
@@ -19,6 +20,8 @@ namespace wrench {
     class PlaceHolderJob;
     class ClusteredJob;
     class OngoingLevel;
+    class ProxyWMS;
+    class LeewaySolver;
 
     class LevelByLevelWMS : public WMS {
 
@@ -40,6 +43,12 @@ namespace wrench {
 
         std::set<PlaceHolderJob *> createPlaceHolderJobsForLevel(unsigned long level);
 
+        double calculateLeeway(PlaceHolderJob *placeholder_job, double runtime, OngoingLevel *previous_level);
+
+        void submitReadyTasks(PlaceHolderJob *placeholder_job);
+
+        void removeOngoingLevelIfFinished(OngoingLevel *ongoing_level);
+
 //        unsigned long computeBestNumNodesBasedOnQueueWaitTimePredictions(ClusteredJob *cj);
 
         Simulator *simulator;
@@ -54,7 +63,11 @@ namespace wrench {
 
         std::shared_ptr<JobManager> job_manager;
 
+        ProxyWMS *proxyWMS;
+        LeewaySolver *leeway_solver;
+
         std::map<int, OngoingLevel *> ongoing_levels;
+        PlaceholderRegistry placeholder_registry;
 
         unsigned long last_level_completed = ULONG_MAX;
     };
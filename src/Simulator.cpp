@@ -9,9 +9,14 @@
 #include <LevelByLevelAlgorithm/LevelByLevelWMS.h>
 #include "Simulator.h"
 #include "Util/WorkflowUtil.h"
+#include "Util/ProxyWMS.h"
+#include "Util/BatschedPredictor.h"
+#include "Util/ProfilePredictor.h"
+#include "Util/QueryProfiler.h"
 #include "StaticClusteringAlgorithms/StaticClusteringWMS.h"
 #include "ZhangClusteringAlgorithms/ZhangWMS.h"
 #include "GlumeAlgorithm/GlumeWMS.h"
+#include "DynamicProgrammingAlgorithm/DynamicProgrammingWMS.h"
 #include "Globals.h"
 
 #include <sys/types.h>
@@ -30,10 +35,32 @@ int Simulator::main(int argc, char **argv) {
     auto simulation = new wrench::Simulation();
     simulation->init(&argc, argv);
 
+    // Parse (and remove) the wait time predictor and parallelism search options
+    std::string predictor_name = "batsched";
+    for (int i = 1; i < argc; i++) {
+        std::string arg = std::string(argv[i]);
+        if (arg.find("--predictor=") == 0) {
+            predictor_name = arg.substr(std::string("--predictor=").length());
+        } else if (arg.find("--parallelism-search=") == 0) {
+            this->parallelism_search = arg.substr(std::string("--parallelism-search=").length());
+        } else {
+            continue;
+        }
+        for (int j = i; j < argc - 1; j++) {
+            argv[j] = argv[j + 1];
+        }
+        argc--;
+        i--;
+    }
+    if ((this->parallelism_search != "exhaustive") and (this->parallelism_search != "golden")) {
+        std::cerr << "Invalid parallelism search " << this->parallelism_search << "\n";
+        exit(1);
+    }
+
     // Parse command-line arguments
     if ((argc != 9) and (argc != 10)) {
         std::cerr << "\e[1;31mUsage: " << argv[0]
-                  << " <num_compute_nodes> <job trace file> <real|fake> <max jobs in system> <workflow specification> <workflow start time> <algorithm> <batch algorithm> [DISABLED: csv batch log file] [OPTIONAL: json result file]\e[0m"
+                  << " <num_compute_nodes> <job trace file> <real|fake> <max jobs in system> <workflow specification> <workflow start time> <algorithm> <batch algorithm> [DISABLED: csv batch log file] [OPTIONAL: json result file] [--predictor=batsched|profile] [--parallelism-search=exhaustive|golden]\e[0m"
                   << "\n";
         std::cerr << "  \e[1;32m### workflow specification options ###\e[0m" << "\n";
         std::cerr << "    *  \e[1mindep:s:n:t1:t2\e[0m " << "\n";
@@ -141,7 +168,7 @@ int Simulator::main(int argc, char **argv) {
                 << "      - The VC algorithm in \"Using Imbalance Metrics to Optimize Task Clustering in Scientific Workflow Executions\" by Chen at al."
                 << "\n";
         std::cerr << "      - Cluster tasks with single-parent-single-child depepdencies" << "\n";
-        std::cerr << "    * \e[1mzhang:[global|noglobal]:[bsearch|nobsearch]:[prediction|noprediction]\e[0m" << "\n";
+        std::cerr << "    * \e[1mzhang:[global|noglobal]:[bsearch|nobsearch]:[prediction|noprediction][:surface]\e[0m" << "\n";
         std::cerr << "      - The algorithm by Zhang, Koelbel, and Cooper + our improvements" << "\n";
         std::cerr << "      - [global|noglobal]: pick the globally best ratio; otherwise, greedily pick" << "\n";
         std::cerr
@@ -149,12 +176,20 @@ int Simulator::main(int argc, char **argv) {
                 << "\n";
         std::cerr << "      - [prediction|noprediction]: pick parallelism based on makespan+wait predictions"
                   << "\n";
-        std::cerr << "    * \e[1mglume:waste_bound:beat_bound\e[0m" << "\n";
+        std::cerr << "      - surface: answer wait time predictions from a grid of queue estimates obtained" << "\n";
+        std::cerr << "        with a single batch scheduler request each time the heuristic runs (conservative)" << "\n";
+        std::cerr << "    * \e[1mglume:waste_bound:beat_bound[:surface]\e[0m" << "\n";
         std::cerr << "      - GLUME: Group Levels Using Makespan Estimates" << "\n";
         std::cerr << "      - waste_bound: maximum percentage of wasted node time e.g. 0.2" << "\n";
         std::cerr
                 << "      - beat_bound: percentage splitting time must beat non-splitting time by to be viable e.g. 0.1"
                 << "\n";
+        std::cerr << "      - surface: same as for zhang" << "\n";
+        std::cerr << "    * \e[1mdp:waste_bound[:surface]\e[0m" << "\n";
+        std::cerr << "      - Plan the best partition of the remaining levels into consecutive jobs by dynamic" << "\n";
+        std::cerr << "        programming over level ranges, and submit the first job of the plan" << "\n";
+        std::cerr << "      - waste_bound: same as for glume" << "\n";
+        std::cerr << "      - surface: same as for zhang" << "\n";
         std::cerr << "    * \e[1mlevelbylevel:[overlap|nooverlap]:levelclustering\e[0m" << "\n";
         std::cerr << "        - A level-by-level-with overlap algorithm that clusters tasks in each level." << "\n";
         std::cerr << "          Tasks in level n+1 are submitted to the batch queue as soon as all tasks in level n"
@@ -206,6 +241,20 @@ int Simulator::main(int argc, char **argv) {
         std::cerr << "    * \e[1mfcfs_fast\e[0m" << "\n";
         std::cerr << "      - first come, first serve" << "\n";
         std::cerr << "\n";
+        std::cerr << "  \e[1;32m### wait time predictor options ###\e[0m" << "\n";
+        std::cerr << "    * \e[1mbatsched\e[0m (default)" << "\n";
+        std::cerr << "      - ask the batch scheduler for start time estimates" << "\n";
+        std::cerr << "    * \e[1mprofile\e[0m" << "\n";
+        std::cerr << "      - estimate start times in-process, from a conservative backfilling reservation list" << "\n";
+        std::cerr << "        of the (SWF) job trace and of the workflow's jobs" << "\n";
+        std::cerr << "\n";
+        std::cerr << "  \e[1;32m### parallelism search options (zhang with prediction) ###\e[0m" << "\n";
+        std::cerr << "    * \e[1mexhaustive\e[0m (default)" << "\n";
+        std::cerr << "      - probe every number of nodes" << "\n";
+        std::cerr << "    * \e[1mgolden\e[0m" << "\n";
+        std::cerr << "      - golden-section search, assuming that wait time + makespan is unimodal in the number of nodes"
+                  << "\n";
+        std::cerr << "\n";
         exit(1);
     }
     unsigned long num_compute_nodes;
@@ -281,6 +330,21 @@ int Simulator::main(int argc, char **argv) {
 
     batch_service = simulation->add(tmp_batch_service);
 
+    // Create the wait time predictor
+    try {
+        if (predictor_name == "batsched") {
+            this->wait_time_predictor = std::make_shared<BatschedPredictor>(batch_service);
+        } else if (predictor_name == "profile") {
+            this->wait_time_predictor = std::make_shared<ProfilePredictor>(std::string(argv[2]), num_compute_nodes,
+                                                                           !strcmp(argv[3], "fake"));
+        } else {
+            throw std::invalid_argument("unknown predictor " + predictor_name);
+        }
+    } catch (std::invalid_argument &e) {
+        std::cerr << "Cannot instantiate the wait time predictor: " << e.what() << "\n";
+        exit(1);
+    }
+
     // Create the WMS
     WMS *wms = nullptr;
     try {
@@ -342,12 +406,19 @@ int Simulator::main(int argc, char **argv) {
         Globals::sim_json["start_time"] = argv[6];
         Globals::sim_json["algorithm"] = argv[7];
         Globals::sim_json["batch_algorithm"] = argv[8];
+        Globals::sim_json["wait_time_predictor"] = predictor_name;
 
         Globals::sim_json["makespan"] = workflow->getCompletionDate() - workflow_start_time;
+        Globals::sim_json["profiling"] = QueryProfiler::toJson();
         Globals::sim_json["num_p_job_exp"] = this->num_pilot_job_expirations_with_remaining_tasks_to_do;
         Globals::sim_json["total_queue_wait"] = this->total_queue_wait_time;
         Globals::sim_json["used_node_sec"] = this->used_node_seconds;
         Globals::sim_json["wasted_node_seconds"] = this->wasted_node_seconds;
+        Globals::sim_json["makespan_cache"]["hits"] = WorkflowUtil::getMakespanCacheHits();
+        Globals::sim_json["makespan_cache"]["misses"] = WorkflowUtil::getMakespanCacheMisses();
+        Globals::sim_json["start_time_estimate_cache"]["hits"] = ProxyWMS::getStartTimeEstimateCacheHits();
+        Globals::sim_json["start_time_estimate_cache"]["misses"] = ProxyWMS::getStartTimeEstimateCacheMisses();
+        Globals::sim_json["start_time_estimate_cache"]["interpolations"] = ProxyWMS::getStartTimeEstimateInterpolations();
 
         // TODO - how to handle runtime errors
 
@@ -621,7 +692,7 @@ WMS *Simulator::createWMS(std::string hostname,
 
     } else if (tokens[0] == "zhang") {
 
-        if (tokens.size() != 4) {
+        if ((tokens.size() != 4) and (tokens.size() != 5)) {
             throw std::invalid_argument("createWMS(): Invalid zhang specification");
         }
 
@@ -651,18 +722,55 @@ WMS *Simulator::createWMS(std::string hostname,
             throw std::invalid_argument("createWMS(): Invalid zhang specification");
         }
 
-        return new ZhangWMS(this, hostname, batch_service, max_num_jobs, global, bsearch, prediction);
+        bool surface = false;
+        if (tokens.size() == 5) {
+            if (tokens[4] == "surface") {
+                surface = true;
+            } else {
+                throw std::invalid_argument("createWMS(): Invalid zhang specification");
+            }
+        }
+
+        return new ZhangWMS(this, hostname, batch_service, max_num_jobs, global, bsearch, prediction, surface);
 
     } else if (tokens[0] == "glume") {
 
-        if (tokens.size() != 3) {
+        if ((tokens.size() != 3) and (tokens.size() != 4)) {
             throw std::invalid_argument("createWMS(): Invalid glume specification");
         }
 
         double waste_bound = std::stod(tokens[1]);
         double beat_bound = std::stod(tokens[2]);
 
-        return new GlumeWMS(this, hostname, waste_bound, beat_bound, batch_service);
+        bool surface = false;
+        if (tokens.size() == 4) {
+            if (tokens[3] == "surface") {
+                surface = true;
+            } else {
+                throw std::invalid_argument("createWMS(): Invalid glume specification");
+            }
+        }
+
+        return new GlumeWMS(this, hostname, waste_bound, beat_bound, surface, batch_service);
+
+    } else if (tokens[0] == "dp") {
+
+        if ((tokens.size() != 2) and (tokens.size() != 3)) {
+            throw std::invalid_argument("createWMS(): Invalid dp specification");
+        }
+
+        double waste_bound = std::stod(tokens[1]);
+
+        bool surface = false;
+        if (tokens.size() == 3) {
+            if (tokens[2] == "surface") {
+                surface = true;
+            } else {
+                throw std::invalid_argument("createWMS(): Invalid dp specification");
+            }
+        }
+
+        return new DynamicProgrammingWMS(this, hostname, waste_bound, surface, batch_service);
 
     } else if (tokens[0] == "levelbylevel") {
         if (tokens.size() != 3) {
@@ -4,6 +4,7 @@
 #define TASK_CLUSTERING_BATCH_SIMULATOR_SIMULATOR_H
 
 #include "wrench-dev.h"
+#include "Util/WaitTimePredictor.h"
 
 
 #define EXECUTION_TIME_FUDGE_FACTOR 1.5
@@ -20,6 +21,11 @@ namespace wrench {
         double wasted_node_seconds = 0;
         double total_queue_wait_time = 0;
 
+        std::shared_ptr<wrench::WaitTimePredictor> wait_time_predictor;
+
+        // How ZhangWMS searches for the best number of nodes based on predictions ("exhaustive" or "golden")
+        std::string parallelism_search = "exhaustive";
+
 
         int main(int argc, char **argv);
 
@@ -8,6 +8,7 @@
  */
 
 #include <Util/WorkflowUtil.h>
+#include <Util/QueryProfiler.h>
 #include "ClusteredJob.h"
 
 XBT_LOG_NEW_DEFAULT_CATEGORY(clustered_job, "Log category for Clustered Job");
@@ -15,17 +16,45 @@ XBT_LOG_NEW_DEFAULT_CATEGORY(clustered_job, "Log category for Clustered Job");
 
 namespace wrench {
 
+    /**
+     * @brief Constructor
+     * @param dag: the DAG snapshot of the workflow whose tasks are clustered
+     */
+    ClusteredJob::ClusteredJob(std::shared_ptr<DagSnapshot> dag) {
+        this->dag = dag;
+    }
+
     void ClusteredJob::addTask(WorkflowTask *task) {
-        this->tasks.push_back(task);
+        if (this->dag == nullptr) {
+            this->dag = WorkflowUtil::getDagSnapshot(task->getWorkflow());
+        }
+        this->task_indices.push_back(this->dag->getIndex(task));
+    }
+
+    void ClusteredJob::addTaskIndex(unsigned long task_index) {
+        if (this->dag == nullptr) {
+            throw std::runtime_error("ClusteredJob::addTaskIndex(): the job has no DAG snapshot");
+        }
+        this->task_indices.push_back(task_index);
     }
 
     bool ClusteredJob::isTaskOK(wrench::WorkflowTask *task) {
         if (task->getState() == wrench::WorkflowTask::READY) {
             return true;
         }
-        for (auto p : task->getWorkflow()->getTaskParents(task)) {
-            if ((p->getState() != wrench::WorkflowTask::COMPLETED) &&
-                (std::find(this->tasks.begin(), this->tasks.end(), p) == this->tasks.end())) {
+        if (this->dag == nullptr) {
+            return false;
+        }
+        return isTaskOK(this->dag->getIndex(task));
+    }
+
+    bool ClusteredJob::isTaskOK(unsigned long task_index) {
+        if (this->dag->getTask(task_index)->getState() == wrench::WorkflowTask::READY) {
+            return true;
+        }
+        for (auto p = this->dag->getParentsBegin(task_index); p != this->dag->getParentsEnd(task_index); p++) {
+            if ((this->dag->getTask(*p)->getState() != wrench::WorkflowTask::COMPLETED) &&
+                (std::find(this->task_indices.begin(), this->task_indices.end(), *p) == this->task_indices.end())) {
                 return false;
             }
         }
@@ -33,7 +62,7 @@ namespace wrench {
     }
 
     bool ClusteredJob::isReady() {
-        for (auto t : this->tasks) {
+        for (auto t : this->task_indices) {
             if (not isTaskOK(t)) {
                 return false;
             }
@@ -47,7 +76,7 @@ namespace wrench {
     }
 
     unsigned long ClusteredJob::getNumTasks() {
-        return this->tasks.size();
+        return this->task_indices.size();
     }
 
     unsigned long ClusteredJob::getNumNodes() {
@@ -55,7 +84,18 @@ namespace wrench {
     }
 
     std::vector<wrench::WorkflowTask *> ClusteredJob::getTasks() {
-        return this->tasks;
+        if (this->dag == nullptr) {
+            return {};
+        }
+        return this->dag->getTasks(this->task_indices);
+    }
+
+    const std::vector<unsigned long> &ClusteredJob::getTaskIndices() {
+        return this->task_indices;
+    }
+
+    std::shared_ptr<DagSnapshot> ClusteredJob::getDagSnapshot() {
+        return this->dag;
     }
 
     double ClusteredJob::estimateMakespan(double core_speed) {
@@ -63,7 +103,7 @@ namespace wrench {
             throw std::runtime_error("estimateMakespan(): Cannot estimate makespan with 0 nodes!");
         }
 
-        return WorkflowUtil::estimateMakespan(this->tasks, this->num_nodes, core_speed);
+        return this->estimateMakespan(core_speed, this->num_nodes);
     }
 
 
@@ -72,7 +112,11 @@ namespace wrench {
             throw std::runtime_error("estimateMakespan(): Cannot estimate makespan with 0 nodes!");
         }
 
-        return WorkflowUtil::estimateMakespan(this->tasks, n, core_speed);
+        if (this->dag == nullptr) {
+            return 0.0;
+        }
+
+        return WorkflowUtil::estimateMakespan(*(this->dag), this->task_indices, n, core_speed);
     }
 
     bool ClusteredJob::isNumNodesBasedOnQueueWaitTimePrediction() {
@@ -82,7 +126,8 @@ namespace wrench {
 
     unsigned long
     ClusteredJob::computeBestNumNodesBasedOnQueueWaitTimePredictions(unsigned long max_num_nodes, double core_speed,
-                                                                     std::shared_ptr<BatchComputeService> batch_service) {
+                                                                     std::shared_ptr<WaitTimePredictor> wait_time_predictor) {
+        QueryProfiler::Phase phase("parallelism");
 
         // Build job configurations
         unsigned long real_max_num_nodes = std::min(this->getNumTasks(), max_num_nodes);
@@ -90,11 +135,18 @@ namespace wrench {
         std::string job_id_prefix = "my_tentative_job";
         std::set<std::tuple<std::string, unsigned long, unsigned long, double>> set_of_job_configurations;
         unsigned long num_jobs = real_max_num_nodes;
+        std::vector<double> makespans;
+        if (this->dag != nullptr) {
+            makespans = WorkflowUtil::estimateMakespanCurve(*(this->dag), this->task_indices, real_max_num_nodes,
+                                                            core_speed);
+        } else {
+            makespans.resize(real_max_num_nodes, 0.0);
+        }
         for (unsigned int n = 1; n <= real_max_num_nodes; n++) {
-            double walltime_seconds = this->estimateMakespan(core_speed, n);
+            double walltime_seconds = makespans[n - 1];
 
             // Calculate the wasted ratio
-            double all_tasks_time = this->estimateMakespan(core_speed, 1);
+            double all_tasks_time = makespans[0];
             double curr_waste = (n * walltime_seconds - all_tasks_time) / (n * walltime_seconds);
             if (curr_waste > this->waste_bound) {
                 num_jobs--;
@@ -118,7 +170,9 @@ namespace wrench {
                     set_of_job_configurations.size());
         std::map<std::string, double> jobs_estimated_start_times;
         try {
-            jobs_estimated_start_times = batch_service->getStartTimeEstimates(set_of_job_configurations);
+            QueryProfiler::Query query(QueryProfiler::HEURISTIC_QUERY, set_of_job_configurations.size());
+            QueryProfiler::Query request(QueryProfiler::SCHEDULER_REQUEST, set_of_job_configurations.size());
+            jobs_estimated_start_times = wait_time_predictor->getStartTimeEstimates(set_of_job_configurations);
         } catch (wrench::WorkflowExecutionException &e) {
             throw std::runtime_error(std::string("Couldn't acquire queue wait time predictions: ") + e.what());
         }
@@ -171,33 +225,36 @@ namespace wrench {
     }
 
     unsigned long ClusteredJob::getMaxParallelism() {
-        auto real_workflow = this->getTasks().at(0)->getWorkflow();
-        auto tmp_workflow = new Workflow();
-        for (auto real_task : this->getTasks()) {
-            tmp_workflow->addTask(real_task->getID(), 1.0, 1, 1, 1.0);
-        }
-
-        for (auto tmp_parent : this->getTasks()) {
-            auto real_task = real_workflow->getTaskByID(tmp_parent->getID());
-            for (auto real_child : real_workflow->getTaskChildren(real_task)) {
-                wrench::WorkflowTask *tmp_child;
-                try {
-                    tmp_child = tmp_workflow->getTaskByID(real_child->getID());
-                } catch (std::invalid_argument &e) {
-                    // Not in clustered job
-                    continue;
+        if (this->dag == nullptr) {
+            return 0;
+        }
+
+        // Top levels within the job: indices are ordered level by level in the DAG,
+        // so parents are always visited before their children
+        std::vector<unsigned long> sorted_tasks(this->task_indices);
+        std::sort(sorted_tasks.begin(), sorted_tasks.end());
+        sorted_tasks.erase(std::unique(sorted_tasks.begin(), sorted_tasks.end()), sorted_tasks.end());
+
+        std::unordered_map<unsigned long, unsigned long> job_levels;
+        std::vector<unsigned long> num_tasks_in_level;
+        for (auto t : sorted_tasks) {
+            unsigned long level = 0;
+            for (auto p = this->dag->getParentsBegin(t); p != this->dag->getParentsEnd(t); p++) {
+                auto parent_level = job_levels.find(*p);
+                if (parent_level != job_levels.end()) {
+                    level = std::max<unsigned long>(level, parent_level->second + 1);
                 }
-                // In clustered Job
-                tmp_workflow->addControlDependency(tmp_parent, tmp_child);
             }
+            job_levels[t] = level;
+            if (num_tasks_in_level.size() <= level) {
+                num_tasks_in_level.resize(level + 1, 0);
+            }
+            num_tasks_in_level[level]++;
         }
 
         unsigned long max_parallelism = 0;
-        for (unsigned int level = 0; level < tmp_workflow->getNumLevels(); level++) {
-            unsigned long num_tasks_in_level = tmp_workflow->getTasksInTopLevelRange(level, level).size();
-            if (max_parallelism < num_tasks_in_level) {
-                max_parallelism = num_tasks_in_level;
-            }
+        for (auto num_tasks : num_tasks_in_level) {
+            max_parallelism = std::max<unsigned long>(max_parallelism, num_tasks);
         }
 
         return max_parallelism;
@@ -12,12 +12,18 @@
 
 #include <wrench-dev.h>
 #include "Simulator.h"
+#include "Util/DagSnapshot.h"
+#include "Util/WaitTimePredictor.h"
 
 namespace wrench {
 
     class ClusteredJob {
 
     public:
+        ClusteredJob() = default;
+
+        explicit ClusteredJob(std::shared_ptr<DagSnapshot> dag);
+
         void setNumNodes(unsigned long num_nodes, bool based_on_queue_wait_time_prediction = false);
 
         unsigned long getNumNodes();
@@ -26,8 +32,14 @@ namespace wrench {
 
         std::vector<wrench::WorkflowTask *> getTasks();
 
+        const std::vector<unsigned long> &getTaskIndices();
+
+        std::shared_ptr<DagSnapshot> getDagSnapshot();
+
         void addTask(wrench::WorkflowTask *task);
 
+        void addTaskIndex(unsigned long task_index);
+
         bool isReady();
 
         bool isTaskOK(wrench::WorkflowTask *task);
@@ -39,14 +51,17 @@ namespace wrench {
         unsigned long getMaxParallelism();
 
         unsigned long computeBestNumNodesBasedOnQueueWaitTimePredictions(unsigned long max_num_nodes, double core_speed,
-                                                                         std::shared_ptr<BatchComputeService> batch_service);
+                                                                         std::shared_ptr<WaitTimePredictor> wait_time_predictor);
 
         bool isNumNodesBasedOnQueueWaitTimePrediction();
 
         void setWasteBound(double waste_bound);
 
     private:
-        std::vector<wrench::WorkflowTask *> tasks;
+        bool isTaskOK(unsigned long task_index);
+
+        std::shared_ptr<DagSnapshot> dag;
+        std::vector<unsigned long> task_indices;
         unsigned long num_nodes = 0;
         bool num_nodes_based_on_queue_wait_time_predictions = false;
         double waste_bound = 1;
@@ -3,6 +3,8 @@
 #include <stdio.h>
 
 #include <Util/WorkflowUtil.h>
+#include <Util/DagSnapshot.h>
+#include <Util/IncrementalSchedule.h>
 #include "StaticClusteringWMS.h"
 #include "ClusteredJob.h"
 
@@ -25,6 +27,9 @@ void StaticClusteringWMS::processEventStandardJobCompletion(std::shared_ptr<Stan
     auto job = e->standard_job;
     WRENCH_INFO("Job %s has completed", job->getName().c_str());
 
+    // The job may have completed before its requested execution time
+    this->simulator->wait_time_predictor->notifyJobTermination(job.get());
+
 
     double first_task_start_time = DBL_MAX;
     for (auto const &t : job->getTasks()) {
@@ -316,7 +321,8 @@ void StaticClusteringWMS::submitClusteredJob(ClusteredJob *clustered_job) {
 
     if (num_nodes == 0) {
         num_nodes = clustered_job->computeBestNumNodesBasedOnQueueWaitTimePredictions(
-                std::min<unsigned long>(clustered_job->getMaxParallelism(), this->number_of_nodes), this->core_speed, this->batch_service);
+                std::min<unsigned long>(clustered_job->getMaxParallelism(), this->number_of_nodes), this->core_speed,
+                this->simulator->wait_time_predictor);
     }
 
     // For one_job-max
@@ -345,6 +351,8 @@ void StaticClusteringWMS::submitClusteredJob(ClusteredJob *clustered_job) {
         WRENCH_INFO("Submitting a batch job...");
         // std::cout << "REQUESTING " << (unsigned long) (1 + (makespan * EXECUTION_TIME_FUDGE_FACTOR)) << " " << num_nodes << "\n";
         this->job_manager->submitJob(standard_job, batch_service, batch_job_args);
+        this->simulator->wait_time_predictor->notifyJobSubmission(standard_job.get(), num_nodes,
+                                                                  60.0 * std::stoul(batch_job_args["-t"]));
 //    this->job_map.insert(std::make_pair(standard_job, clustered_job));
     } catch (WorkflowExecutionException &e) {
         throw std::runtime_error("Couldn't submit job: " + e.getCause()->toString());
@@ -362,16 +370,17 @@ std::set<ClusteredJob *> StaticClusteringWMS::createHCJobs(
         mergeSingleParentSingleChildPairs(workflow);
     }
 
+    auto dag = WorkflowUtil::getDagSnapshot(workflow);
+
     // Go through each level and creates jobs
-    for (unsigned long l = start_level; l <= end_level; l++) {
-        auto tasks_in_level = workflow->getTasksInTopLevelRange(l, l);
+    for (unsigned long l = start_level; (l <= end_level) and (l < dag->getNumLevels()); l++) {
         ClusteredJob *job = nullptr;
-        for (auto t : tasks_in_level) {
+        for (unsigned long t = dag->getLevelBegin(l); t < dag->getLevelEnd(l); t++) {
             if (job == nullptr) {
-                job = new ClusteredJob();
+                job = new ClusteredJob(dag);
                 job->setNumNodes(num_nodes_per_cluster);
             }
-            job->addTask(t);
+            job->addTaskIndex(t);
             if (job->getNumTasks() == num_tasks_per_cluster) {
                 jobs.insert(job);
                 job = nullptr;
@@ -401,32 +410,49 @@ std::set<ClusteredJob *> StaticClusteringWMS::createDFJSJobs(
         mergeSingleParentSingleChildPairs(workflow);
     }
 
+    auto dag = WorkflowUtil::getDagSnapshot(workflow);
+
     // Go through each level and creates jobs
-    for (unsigned long l = start_level; l <= end_level; l++) {
-        auto tasks_in_level = workflow->getTasksInTopLevelRange(l, l);
+    for (unsigned long l = start_level; (l <= end_level) and (l < dag->getNumLevels()); l++) {
 
-        auto job = new ClusteredJob();
+        auto job = new ClusteredJob(dag);
         job->setNumNodes(num_nodes_per_cluster);
-        for (auto t : tasks_in_level) {
-            auto task_execution_time = (unsigned long) (ceil(t->getFlops() / core_speed));
+        IncrementalSchedule job_schedule(num_nodes_per_cluster, core_speed);
+
+        // Go through the level's tasks in the makespan estimator's priority order, so that each task
+        // is added after all the tasks already in the job's schedule
+        std::vector<unsigned long> level_tasks;
+        for (unsigned long t = dag->getLevelBegin(l); t < dag->getLevelEnd(l); t++) {
+            level_tasks.push_back(t);
+        }
+        std::sort(level_tasks.begin(), level_tasks.end(), [&dag](unsigned long i, unsigned long j) -> bool {
+            return dag->getPriority(i) < dag->getPriority(j);
+        });
+
+        for (auto t : level_tasks) {
+            auto task_execution_time = (unsigned long) (ceil(dag->getFlops(t) / core_speed));
             if (task_execution_time > num_seconds_per_cluster) {
                 throw std::runtime_error(
-                        "Task " + t->getID() + " by itself takes longer (" + std::to_string(task_execution_time) +
+                        "Task " + dag->getTask(t)->getID() + " by itself takes longer (" + std::to_string(task_execution_time) +
                         " sec) than the cluster duration upper bound ( " +
                         std::to_string(num_seconds_per_cluster) + " sec)!");
             }
-            // Should we add to the job?
-            std::vector<wrench::WorkflowTask *> tentative_tasks = job->getTasks();
-            tentative_tasks.push_back(t);
-            double estimated_makespan = WorkflowUtil::estimateMakespan(tentative_tasks, num_nodes_per_cluster,
-                                                                       core_speed);
+            // Should we add to the job? (tasks in a level are independent, so the job's schedule
+            // can be extended one task at a time, in O(log(num_nodes_per_cluster)); with the
+            // estimator's priorities, its makespan is the job's estimated makespan, which the
+            // requested walltime is based on)
+            double estimated_makespan = job_schedule.tryAddTask(dag->getFlops(t), dag->getPriority(t));
             if ((unsigned long) (ceil(estimated_makespan)) <= num_seconds_per_cluster) {
-                job->addTask(t);
+                job_schedule.commit();
+                job->addTaskIndex(t);
             } else {
+                job_schedule.rollback();
                 jobs.insert(job);
-                job = new ClusteredJob();
+                job = new ClusteredJob(dag);
                 job->setNumNodes(num_nodes_per_cluster);
-                job->addTask(t);
+                job->addTaskIndex(t);
+                job_schedule = IncrementalSchedule(num_nodes_per_cluster, core_speed);
+                job_schedule.addTask(dag->getFlops(t), dag->getPriority(t));
             }
         }
         jobs.insert(job);
@@ -457,23 +483,29 @@ std::set<ClusteredJob *> StaticClusteringWMS::createHRBJobs(
         mergeSingleParentSingleChildPairs(workflow);
     }
 
+    auto dag = WorkflowUtil::getDagSnapshot(workflow);
+
     // Go through each level and creates jobs
-    for (unsigned long l = start_level; l <= end_level; l++) {
-        auto tasks_in_level = workflow->getTasksInTopLevelRange(l, l);
+    for (unsigned long l = start_level; (l <= end_level) and (l < dag->getNumLevels()); l++) {
+        auto tasks_in_level = dag->getIndicesInTopLevelRange(l, l);
 
         // Create all the jobs
         unsigned long num_level_jobs = tasks_in_level.size() / num_tasks_per_cluster +
                                        (tasks_in_level.size() % num_tasks_per_cluster != 0);
 
         ClusteredJob *level_jobs[num_level_jobs];
+        std::vector<IncrementalSchedule> level_job_schedules;
         for (unsigned long i = 0; i < num_level_jobs; i++) {
-            level_jobs[i] = new ClusteredJob();
+            level_jobs[i] = new ClusteredJob(dag);
             level_jobs[i]->setNumNodes(num_nodes_per_cluster);
+            level_job_schedules.emplace_back(num_nodes_per_cluster, core_speed);
         }
 
         // Sort the tasks by decreasing Flops
         std::sort(tasks_in_level.begin(), tasks_in_level.end(),
-                  [](const wrench::WorkflowTask *t1, const wrench::WorkflowTask *t2) -> bool {
+                  [&dag](unsigned long i1, unsigned long i2) -> bool {
+                      const wrench::WorkflowTask *t1 = dag->getTask(i1);
+                      const wrench::WorkflowTask *t2 = dag->getTask(i2);
                       if (fabs(t1->getFlops() - t2->getFlops()) < 0.001) {
                           return ((uintptr_t) t1 > (uintptr_t) t2);
                       } else {
@@ -483,22 +515,24 @@ std::set<ClusteredJob *> StaticClusteringWMS::createHRBJobs(
 
         // Assign each task to a job
         for (auto t : tasks_in_level) {
-            // Find the job with the min completion time
+            // Find the non-full job with the min completion time
             unsigned long selected_index = 0;
-            for (unsigned long i = 1; i < num_level_jobs; i++) {
-                double currently_selected_makespan = WorkflowUtil::estimateMakespan(
-                        level_jobs[selected_index]->getTasks(),
-                        num_nodes_per_cluster, core_speed);
-                double candidate_makespan = WorkflowUtil::estimateMakespan(
-                        level_jobs[i]->getTasks(),
-                        num_nodes_per_cluster, core_speed);
+            while (level_jobs[selected_index]->getNumTasks() >= num_tasks_per_cluster) {
+                selected_index++;
+            }
+            for (unsigned long i = selected_index + 1; i < num_level_jobs; i++) {
+                double currently_selected_makespan = level_job_schedules[selected_index].getMakespan();
+                double candidate_makespan = level_job_schedules[i].getMakespan();
                 if ((candidate_makespan < currently_selected_makespan) and
                     (level_jobs[i]->getNumTasks() < num_tasks_per_cluster)) {
                     selected_index = i;
                 }
             }
 //      WRENCH_INFO("ADDING TASK (%lf) TO JOB %ld", t->getFlops(), selected_index);
-            level_jobs[selected_index]->addTask(t);
+            level_jobs[selected_index]->addTaskIndex(t);
+            if (num_level_jobs > 1) {  // Makespans are only needed to compare jobs
+                level_job_schedules[selected_index].addTask(dag->getFlops(t));
+            }
         }
 
         // Put the jobs into the overall job set
@@ -525,21 +559,22 @@ std::set<ClusteredJob *> StaticClusteringWMS::createHIFBJobs(
         mergeSingleParentSingleChildPairs(workflow);
     }
 
+    auto dag = WorkflowUtil::getDagSnapshot(workflow);
+
     /** Compute all task "Impact Factors" **/
 //  WRENCH_INFO("Compute all IFs");
-    std::map<wrench::WorkflowTask *, double> impact_factors;
-    for (unsigned long l = 0; l < workflow->getNumLevels(); l++) {
-        unsigned long level = workflow->getNumLevels() - 1 - l;
-        auto tasks_in_level = workflow->getTasksInTopLevelRange(level, level);
-        for (auto t : tasks_in_level) {
-            if (t->getNumberOfChildren() == 0) {
-                impact_factors.insert(std::make_pair(t, 1.0));
+    std::vector<double> impact_factors(dag->getNumTasks(), 0.0);
+    for (unsigned long l = 0; l < dag->getNumLevels(); l++) {
+        unsigned long level = dag->getNumLevels() - 1 - l;
+        for (unsigned long t = dag->getLevelBegin(level); t < dag->getLevelEnd(level); t++) {
+            if (dag->getNumChildren(t) == 0) {
+                impact_factors[t] = 1.0;
             } else {
                 double impact_factor = 0.0;
-                for (auto child : workflow->getTaskChildren(t)) {
-                    impact_factor += impact_factors[child] / child->getNumberOfParents();
+                for (auto child = dag->getChildrenBegin(t); child != dag->getChildrenEnd(t); child++) {
+                    impact_factor += impact_factors[*child] / dag->getNumParents(*child);
                 }
-                impact_factors.insert(std::make_pair(t, impact_factor));
+                impact_factors[t] = impact_factor;
             }
         }
     }
@@ -549,9 +584,9 @@ std::set<ClusteredJob *> StaticClusteringWMS::createHIFBJobs(
 //  }
 
     /** Go through each level and creates jobs **/
-    for (unsigned long l = start_level; l <= end_level; l++) {
+    for (unsigned long l = start_level; (l <= end_level) and (l < dag->getNumLevels()); l++) {
 
-        auto tasks_in_level = workflow->getTasksInTopLevelRange(l, l);
+        auto tasks_in_level = dag->getIndicesInTopLevelRange(l, l);
 
         // Create all the jobs
         unsigned long num_level_jobs = tasks_in_level.size() / num_tasks_per_cluster +
@@ -559,13 +594,15 @@ std::set<ClusteredJob *> StaticClusteringWMS::createHIFBJobs(
 
         ClusteredJob **level_jobs = (ClusteredJob **) calloc(num_level_jobs, sizeof(ClusteredJob *));
         for (unsigned long i = 0; i < num_level_jobs; i++) {
-            level_jobs[i] = new ClusteredJob();
+            level_jobs[i] = new ClusteredJob(dag);
             level_jobs[i]->setNumNodes(num_nodes_per_cluster);
         }
 
         // Sort the tasks by decreasing Flops
         std::sort(tasks_in_level.begin(), tasks_in_level.end(),
-                  [](const wrench::WorkflowTask *t1, const wrench::WorkflowTask *t2) -> bool {
+                  [&dag](unsigned long i1, unsigned long i2) -> bool {
+                      const wrench::WorkflowTask *t1 = dag->getTask(i1);
+                      const wrench::WorkflowTask *t2 = dag->getTask(i2);
 
                       if (fabs(t1->getFlops() - t2->getFlops()) < 0.001) {
                           return ((uintptr_t) t1 > (uintptr_t) t2);
@@ -584,7 +621,7 @@ std::set<ClusteredJob *> StaticClusteringWMS::createHIFBJobs(
 
                 // compute average impact_factor value
                 double average_IF = 0.0;
-                for (auto task_in_job : level_jobs[i]->getTasks()) {
+                for (auto task_in_job : level_jobs[i]->getTaskIndices()) {
                     average_IF += impact_factors[task_in_job];
                 }
                 average_IF += impact_factors[t];
@@ -592,7 +629,7 @@ std::set<ClusteredJob *> StaticClusteringWMS::createHIFBJobs(
 
                 // compute standard deviation
                 double similarity = 0.0;
-                for (auto task_in_job : level_jobs[i]->getTasks()) {
+                for (auto task_in_job : level_jobs[i]->getTaskIndices()) {
                     similarity += pow(impact_factors[task_in_job] - average_IF, 2.0);
                 }
                 similarity += pow(impact_factors[t] - average_IF, 2.0);
@@ -608,7 +645,7 @@ std::set<ClusteredJob *> StaticClusteringWMS::createHIFBJobs(
 
             // Sort jobs by similarity, and makespan when similarity is the same
             std::sort(IF_similarity.begin(), IF_similarity.end(),
-                      [num_nodes_per_cluster](const std::pair<ClusteredJob *, double> &t1,
+                      [&dag, num_nodes_per_cluster](const std::pair<ClusteredJob *, double> &t1,
                                               const std::pair<ClusteredJob *, double> &t2) -> bool {
                           double t1_similarity = t1.second;
                           double t2_similarity = t2.second;
@@ -619,9 +656,9 @@ std::set<ClusteredJob *> StaticClusteringWMS::createHIFBJobs(
 //                    WRENCH_INFO("  IN SORT: %ld %ld", (unsigned long)t1_job, (unsigned long)t2_job);
 
                           if (fabs(t1_similarity - t2_similarity) < 0.01) { // IMPORTANT TO NOT USE EQUAL!
-                              double t1_makespan = WorkflowUtil::estimateMakespan(t1_job->getTasks(),
+                              double t1_makespan = WorkflowUtil::estimateMakespan(*dag, t1_job->getTaskIndices(),
                                                                                   num_nodes_per_cluster, 1.0);
-                              double t2_makespan = WorkflowUtil::estimateMakespan(t2_job->getTasks(),
+                              double t2_makespan = WorkflowUtil::estimateMakespan(*dag, t2_job->getTaskIndices(),
                                                                                   num_nodes_per_cluster, 1.0);
                               if (fabs(t1_makespan - t2_makespan) < 0.01) {
                                   return ((uintptr_t) &t1 > (uintptr_t) &t2);
@@ -639,7 +676,7 @@ std::set<ClusteredJob *> StaticClusteringWMS::createHIFBJobs(
             for (auto p : IF_similarity) {
                 ClusteredJob *job = std::get<0>(p);
                 if (job->getNumTasks() < num_tasks_per_cluster) {
-                    job->addTask(t);
+                    job->addTaskIndex(t);
 //          WRENCH_INFO("PUTTING TASK %s into job %ld", t->getID().c_str(), (unsigned long)(job));
                     task_was_put_into_job = true;
                     break;
@@ -647,7 +684,7 @@ std::set<ClusteredJob *> StaticClusteringWMS::createHIFBJobs(
             }
 
             if (not task_was_put_into_job) {
-                throw std::runtime_error("Cannot put task " + t->getID() + " into any cluster!");
+                throw std::runtime_error("Cannot put task " + dag->getTask(t)->getID() + " into any cluster!");
             }
 
         }
@@ -676,13 +713,15 @@ std::set<ClusteredJob *> StaticClusteringWMS::createHDBJobs(
         mergeSingleParentSingleChildPairs(workflow);
     }
 
+    auto dag = WorkflowUtil::getDagSnapshot(workflow);
+
     /** Compute all task distances **/
-    std::map<std::pair<wrench::WorkflowTask *, wrench::WorkflowTask *>, unsigned long> task_distances;
-    for (unsigned long l = 0; l <= workflow->getNumLevels(); l++) {
-        unsigned long level = workflow->getNumLevels() - 1 - l;
-        std::vector<wrench::WorkflowTask *> tasks_in_level = workflow->getTasksInTopLevelRange(level, level);
+    std::map<std::pair<unsigned long, unsigned long>, unsigned long> task_distances;
+    for (unsigned long l = 0; l < dag->getNumLevels(); l++) {
+        unsigned long level = dag->getNumLevels() - 1 - l;
+        std::vector<unsigned long> tasks_in_level = dag->getIndicesInTopLevelRange(level, level);
         // Last level
-        if (level == workflow->getNumLevels() - 1) {
+        if (level == dag->getNumLevels() - 1) {
             for (auto u : tasks_in_level) {
                 for (auto v : tasks_in_level) {
                     if (u != v) {
@@ -694,13 +733,11 @@ std::set<ClusteredJob *> StaticClusteringWMS::createHDBJobs(
             for (auto u : tasks_in_level) {
                 for (auto v : tasks_in_level) {
                     if (u != v) {
-                        std::vector<wrench::WorkflowTask *> u_children = workflow->getTaskChildren(u);
-                        std::vector<wrench::WorkflowTask *> v_children = workflow->getTaskChildren(v);
                         double min_distance = -1.0;
-                        for (auto cu : u_children) {
-                            for (auto cv : v_children) {
-                                if ((min_distance == -1.0) or (task_distances[std::make_pair(cu, cv)] < min_distance)) {
-                                    min_distance = task_distances[std::make_pair(cu, cv)];
+                        for (auto cu = dag->getChildrenBegin(u); cu != dag->getChildrenEnd(u); cu++) {
+                            for (auto cv = dag->getChildrenBegin(v); cv != dag->getChildrenEnd(v); cv++) {
+                                if ((min_distance == -1.0) or (task_distances[std::make_pair(*cu, *cv)] < min_distance)) {
+                                    min_distance = task_distances[std::make_pair(*cu, *cv)];
                                 }
                             }
                         }
@@ -729,9 +766,9 @@ std::set<ClusteredJob *> StaticClusteringWMS::createHDBJobs(
 
 
     /** Go through each level and creates jobs **/
-    for (unsigned long l = start_level; l <= end_level; l++) {
+    for (unsigned long l = start_level; (l <= end_level) and (l < dag->getNumLevels()); l++) {
 
-        auto tasks_in_level = workflow->getTasksInTopLevelRange(l, l);
+        auto tasks_in_level = dag->getIndicesInTopLevelRange(l, l);
 
         // Create all the jobs
         unsigned long num_level_jobs = tasks_in_level.size() / num_tasks_per_cluster +
@@ -739,13 +776,15 @@ std::set<ClusteredJob *> StaticClusteringWMS::createHDBJobs(
 
         ClusteredJob **level_jobs = (ClusteredJob **) calloc(num_level_jobs, sizeof(ClusteredJob *));
         for (unsigned long i = 0; i < num_level_jobs; i++) {
-            level_jobs[i] = new ClusteredJob();
+            level_jobs[i] = new ClusteredJob(dag);
             level_jobs[i]->setNumNodes(num_nodes_per_cluster);
         }
 
         // Sort the tasks by decreasing Flops
         std::sort(tasks_in_level.begin(), tasks_in_level.end(),
-                  [](const wrench::WorkflowTask *t1, const wrench::WorkflowTask *t2) -> bool {
+                  [&dag](unsigned long i1, unsigned long i2) -> bool {
+                      const wrench::WorkflowTask *t1 = dag->getTask(i1);
+                      const wrench::WorkflowTask *t2 = dag->getTask(i2);
 
                       if (fabs(t1->getFlops() - t2->getFlops()) < 0.001) {
                           return ((uintptr_t) t1 > (uintptr_t) t2);
@@ -765,8 +804,8 @@ std::set<ClusteredJob *> StaticClusteringWMS::createHDBJobs(
 
                 // compute  distance similarity
                 double average_distance = 0.0;
-                for (auto u : level_jobs[i]->getTasks()) {
-                    for (auto v : level_jobs[i]->getTasks()) {
+                for (auto u : level_jobs[i]->getTaskIndices()) {
+                    for (auto v : level_jobs[i]->getTaskIndices()) {
                         if (u == v) {
                             continue;
                         }
@@ -778,8 +817,8 @@ std::set<ClusteredJob *> StaticClusteringWMS::createHDBJobs(
 
                 // compute standard deviation
                 double similarity = 0.0;
-                for (auto u : level_jobs[i]->getTasks()) {
-                    for (auto v : level_jobs[i]->getTasks()) {
+                for (auto u : level_jobs[i]->getTaskIndices()) {
+                    for (auto v : level_jobs[i]->getTaskIndices()) {
                         if (u == v) {
                             continue;
                         }
@@ -799,7 +838,7 @@ std::set<ClusteredJob *> StaticClusteringWMS::createHDBJobs(
 
             // Sort jobs by similarity, and makespan when similarity is the same
             std::sort(distance_similarity.begin(), distance_similarity.end(),
-                      [num_nodes_per_cluster](const std::pair<ClusteredJob *, double> &t1,
+                      [&dag, num_nodes_per_cluster](const std::pair<ClusteredJob *, double> &t1,
                                               const std::pair<ClusteredJob *, double> &t2) -> bool {
                           double t1_similarity = t1.second;
                           double t2_similarity = t2.second;
@@ -810,9 +849,9 @@ std::set<ClusteredJob *> StaticClusteringWMS::createHDBJobs(
 //                    WRENCH_INFO("  IN SORT: %ld %ld", (unsigned long)t1_job, (unsigned long)t2_job);
 
                           if (fabs(t1_similarity - t2_similarity) < 0.01) { // IMPORTANT TO NOT USE EQUAL!
-                              double t1_makespan = WorkflowUtil::estimateMakespan(t1_job->getTasks(),
+                              double t1_makespan = WorkflowUtil::estimateMakespan(*dag, t1_job->getTaskIndices(),
                                                                                   num_nodes_per_cluster, 1.0);
-                              double t2_makespan = WorkflowUtil::estimateMakespan(t2_job->getTasks(),
+                              double t2_makespan = WorkflowUtil::estimateMakespan(*dag, t2_job->getTaskIndices(),
                                                                                   num_nodes_per_cluster, 1.0);
                               if (fabs(t1_makespan - t2_makespan) < 0.01) {
                                   return ((uintptr_t) &t1 > (uintptr_t) &t2);
@@ -830,7 +869,7 @@ std::set<ClusteredJob *> StaticClusteringWMS::createHDBJobs(
             for (auto p : distance_similarity) {
                 ClusteredJob *job = std::get<0>(p);
                 if (job->getNumTasks() < num_tasks_per_cluster) {
-                    job->addTask(t);
+                    job->addTaskIndex(t);
 //          WRENCH_INFO("PUTTING TASK %s into job %ld", t->getID().c_str(), (unsigned long)(job));
                     task_was_put_into_job = true;
                     break;
@@ -838,7 +877,7 @@ std::set<ClusteredJob *> StaticClusteringWMS::createHDBJobs(
             }
 
             if (not task_was_put_into_job) {
-                throw std::runtime_error("Cannot put task " + t->getID() + " into any cluster!");
+                throw std::runtime_error("Cannot put task " + dag->getTask(t)->getID() + " into any cluster!");
             }
 
         }
@@ -878,20 +917,21 @@ void StaticClusteringWMS::mergeSingleParentSingleChildPairs(Workflow *workflow)
         // do the merge
         // WRENCH_INFO("MERGING %s and %s", parent_to_merge->getID().c_str(), child_to_merge->getID().c_str());
 
-        wrench::WorkflowTask *merged_task = workflow->addTask(
+        wrench::WorkflowTask *merged_task = WorkflowUtil::addTask(
+                workflow,
                 parent_to_merge->getID() + "_" + child_to_merge->getID(),
                 parent_to_merge->getFlops() + child_to_merge->getFlops(),
                 1, 1, 1.0);
 
         for (auto parent : workflow->getTaskParents(parent_to_merge)) {
-            workflow->addControlDependency(parent, merged_task);
+            WorkflowUtil::addControlDependency(workflow, parent, merged_task);
         }
         for (auto child : workflow->getTaskChildren(child_to_merge)) {
-            workflow->addControlDependency(merged_task, child);
+            WorkflowUtil::addControlDependency(workflow, merged_task, child);
         }
 
-        workflow->removeTask(parent_to_merge);
-        workflow->removeTask(child_to_merge);
+        WorkflowUtil::removeTask(workflow, parent_to_merge);
+        WorkflowUtil::removeTask(workflow, child_to_merge);
 
     }
 }
@@ -941,18 +981,18 @@ StaticClusteringWMS::applyPosteriorVC(Workflow *workflow, std::set<ClusteredJob
 
         if (to_merge_1 != nullptr) {
             /** Do the merge **/
-            ClusteredJob *new_job = new ClusteredJob();
+            ClusteredJob *new_job = new ClusteredJob(to_merge_1->getDagSnapshot());
             // Set the number of nodes
             if (to_merge_1->getNumNodes() != to_merge_2->getNumNodes()) {
                 throw std::runtime_error("Posterior VC: Don't know how to merge jobs with different numbers of nodes");
             }
             new_job->setNumNodes(to_merge_1->getNumNodes());
             // Add the tasks
-            for (auto t : to_merge_1->getTasks()) {
-                new_job->addTask(t);
+            for (auto t : to_merge_1->getTaskIndices()) {
+                new_job->addTaskIndex(t);
             }
-            for (auto t : to_merge_2->getTasks()) {
-                new_job->addTask(t);
+            for (auto t : to_merge_2->getTaskIndices()) {
+                new_job->addTaskIndex(t);
             }
             // Add the job
             output_jobs.insert(new_job);
@@ -979,11 +1019,17 @@ bool StaticClusteringWMS::areJobsMergable(Workflow *workflow, ClusteredJob *j1,
 
 bool StaticClusteringWMS::isSingleParentSingleChildPair(Workflow *workflow, ClusteredJob *pj, ClusteredJob *cj) {
 
-    for (auto parent_task : pj->getTasks()) {
-        for (auto child_task : workflow->getTaskChildren(parent_task)) {
-            std::vector<wrench::WorkflowTask *> cj_tasks = cj->getTasks();
+    auto dag = pj->getDagSnapshot();
+    if (dag == nullptr) {
+        return true;
+    }
+
+    const std::vector<unsigned long> &cj_tasks = cj->getTaskIndices();
+    const std::vector<unsigned long> &pj_tasks = pj->getTaskIndices();
+    for (auto parent_task : pj_tasks) {
+        for (auto c = dag->getChildrenBegin(parent_task); c != dag->getChildrenEnd(parent_task); c++) {
+            unsigned long child_task = *c;
             bool child_task_in_cj = std::find(cj_tasks.begin(), cj_tasks.end(), child_task) != cj_tasks.end();
-            std::vector<wrench::WorkflowTask *> pj_tasks = pj->getTasks();
             bool child_task_in_pj = std::find(pj_tasks.begin(), pj_tasks.end(), child_task) != pj_tasks.end();
             if ((not child_task_in_cj) and (not child_task_in_pj)) {
                 return false;
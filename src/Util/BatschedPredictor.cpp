@@ -0,0 +1,36 @@
+/**
+ * Copyright (c) 2017. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+
+#include "BatschedPredictor.h"
+
+
+namespace wrench {
+
+    /**
+     * @brief Constructor
+     * @param batch_service: the batch service
+     */
+    BatschedPredictor::BatschedPredictor(std::shared_ptr<BatchComputeService> batch_service) {
+        this->batch_service = batch_service;
+    }
+
+    /**
+     * @brief Get start date estimates from the batch service
+     * @param job_configurations: (unique key, number of nodes, number of cores per node, requested execution time) tuples
+     * @return start date estimates, by key
+     *
+     * @throw WorkflowExecutionException
+     */
+    std::map<std::string, double> BatschedPredictor::getStartTimeEstimates(
+            std::set<std::tuple<std::string, unsigned long, unsigned long, double>> job_configurations) {
+        return this->batch_service->getStartTimeEstimates(job_configurations);
+    }
+
+};
@@ -0,0 +1,41 @@
+/**
+ * Copyright (c) 2017. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+
+#ifndef TASK_CLUSTERING_BATCH_SIMULATOR_BATSCHEDPREDICTOR_H
+#define TASK_CLUSTERING_BATCH_SIMULATOR_BATSCHEDPREDICTOR_H
+
+
+#include <wrench-dev.h>
+#include "WaitTimePredictor.h"
+
+namespace wrench {
+
+    /**
+     * @brief A wait time predictor that asks the batch service (i.e., batsched) for its start time estimates
+     */
+    class BatschedPredictor : public WaitTimePredictor {
+
+    public:
+
+        explicit BatschedPredictor(std::shared_ptr<BatchComputeService> batch_service);
+
+        std::map<std::string, double>
+        getStartTimeEstimates(std::set<std::tuple<std::string, unsigned long, unsigned long, double>> job_configurations) override;
+
+    private:
+
+        std::shared_ptr<BatchComputeService> batch_service;
+
+    };
+
+};
+
+
+#endif //TASK_CLUSTERING_BATCH_SIMULATOR_BATSCHEDPREDICTOR_H
@@ -0,0 +1,248 @@
+/**
+ * Copyright (c) 2017. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+
+#include <wrench-dev.h>
+
+#include "DagSnapshot.h"
+
+
+namespace wrench {
+
+    static uint64_t num_built_snapshots = 0;
+
+    /**
+     * @brief The SplitMix64 mixing function
+     * @param x: a 64-bit value
+     * @return a well-mixed 64-bit value
+     */
+    static uint64_t splitMix64(uint64_t x) {
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    /**
+     * @brief Constructor
+     * @param workflow: the workflow whose current DAG is captured
+     */
+    DagSnapshot::DagSnapshot(Workflow *workflow) {
+
+        if (workflow == nullptr) {
+            throw std::invalid_argument("DagSnapshot::DagSnapshot(): invalid workflow");
+        }
+
+        this->workflow = workflow;
+        this->version = 0;
+
+        std::unordered_map<WorkflowTask *, std::vector<WorkflowTask *>> task_parents;
+        for (auto task : workflow->getTasks()) {
+            task_parents[task] = task->getParents();
+        }
+        this->build(task_parents);
+    }
+
+    /**
+     * @brief Constructor
+     * @param workflow: the workflow whose current DAG is captured
+     * @param task_parents: the parents of each of the workflow's tasks
+     * @param version: the version of the workflow's DAG
+     */
+    DagSnapshot::DagSnapshot(Workflow *workflow,
+                             const std::unordered_map<WorkflowTask *, std::vector<WorkflowTask *>> &task_parents,
+                             unsigned long version) {
+
+        if (workflow == nullptr) {
+            throw std::invalid_argument("DagSnapshot::DagSnapshot(): invalid workflow");
+        }
+
+        this->workflow = workflow;
+        this->version = version;
+        this->build(task_parents);
+    }
+
+    /**
+     * @brief Build the snapshot's arrays
+     * @param task_parents: the parents of each of the workflow's tasks
+     */
+    void DagSnapshot::build(const std::unordered_map<WorkflowTask *, std::vector<WorkflowTask *>> &task_parents) {
+
+        // Number tasks level by level, after bucketing them by level in a single pass (in the order in
+        // which Workflow::getTasks() returns them, which is also that of Workflow::getTasksInTopLevelRange())
+        unsigned long num_levels = workflow->getNumLevels();
+        std::vector<std::vector<WorkflowTask *>> level_tasks(num_levels);
+        for (auto task : workflow->getTasks()) {
+            level_tasks[task->getTopLevel()].push_back(task);
+        }
+        this->level_offsets.push_back(0);
+        for (unsigned long l = 0; l < num_levels; l++) {
+            for (auto task : level_tasks[l]) {
+                this->task_indices[task] = this->tasks.size();
+                this->tasks.push_back(task);
+                this->flops.push_back(task->getFlops());
+                this->levels.push_back(l);
+            }
+            this->level_offsets.push_back(this->tasks.size());
+        }
+
+        unsigned long num_tasks = this->tasks.size();
+
+        // Prefix sums of the flops per level
+        this->level_flops_prefix.push_back(0.0);
+        for (unsigned long l = 0; l < num_levels; l++) {
+            double level_flops = 0.0;
+            for (unsigned long i = this->level_offsets[l]; i < this->level_offsets[l + 1]; i++) {
+                level_flops += this->flops[i];
+            }
+            this->level_flops_prefix.push_back(this->level_flops_prefix.back() + level_flops);
+        }
+
+        // Rank tasks by address, which is the order in which the makespan estimator prioritizes them
+        std::vector<unsigned long> by_address(num_tasks);
+        for (unsigned long i = 0; i < num_tasks; i++) {
+            by_address[i] = i;
+        }
+        std::sort(by_address.begin(), by_address.end(), [this](unsigned long i, unsigned long j) -> bool {
+            return std::less<WorkflowTask *>()(this->tasks[i], this->tasks[j]);
+        });
+        this->priorities.resize(num_tasks);
+        for (unsigned long rank = 0; rank < num_tasks; rank++) {
+            this->priorities[by_address[rank]] = rank;
+        }
+
+        // Task keys, which differ from one snapshot to the next so that fingerprints never outlive a snapshot
+        uint64_t seed = splitMix64(++num_built_snapshots);
+        this->task_keys.resize(num_tasks);
+        for (unsigned long i = 0; i < num_tasks; i++) {
+            this->task_keys[i] = splitMix64(seed + i);
+        }
+
+        // Parents and children, in CSR form
+        this->parent_offsets.reserve(num_tasks + 1);
+        this->parent_offsets.push_back(0);
+        for (unsigned long i = 0; i < num_tasks; i++) {
+            auto parents = task_parents.find(this->tasks[i]);
+            if (parents == task_parents.end()) {
+                throw std::invalid_argument("DagSnapshot::build(): no parent list for task " + this->tasks[i]->getID());
+            }
+            for (auto parent : parents->second) {
+                this->parent_indices.push_back(this->getIndex(parent));
+            }
+            this->parent_offsets.push_back(this->parent_indices.size());
+        }
+
+        std::vector<unsigned long> num_children(num_tasks, 0);
+        for (auto parent : this->parent_indices) {
+            num_children[parent]++;
+        }
+        this->child_offsets.resize(num_tasks + 1);
+        this->child_offsets[0] = 0;
+        for (unsigned long i = 0; i < num_tasks; i++) {
+            this->child_offsets[i + 1] = this->child_offsets[i] + num_children[i];
+        }
+        this->child_indices.resize(this->parent_indices.size());
+        std::vector<unsigned long> next_child(this->child_offsets.begin(), this->child_offsets.end() - 1);
+        for (unsigned long i = 0; i < num_tasks; i++) {
+            for (auto parent = this->getParentsBegin(i); parent != this->getParentsEnd(i); parent++) {
+                this->child_indices[next_child[*parent]++] = i;
+            }
+        }
+    }
+
+    /**
+     * @brief Get the workflow
+     * @return the workflow
+     */
+    Workflow *DagSnapshot::getWorkflow() const {
+        return this->workflow;
+    }
+
+    /**
+     * @brief Get the version of the workflow's DAG that this snapshot captures
+     * @return a version number
+     */
+    unsigned long DagSnapshot::getVersion() const {
+        return this->version;
+    }
+
+    /**
+     * @brief Get the number of tasks
+     * @return a number of tasks
+     */
+    unsigned long DagSnapshot::getNumTasks() const {
+        return this->tasks.size();
+    }
+
+    /**
+     * @brief Get the number of levels
+     * @return a number of levels
+     */
+    unsigned long DagSnapshot::getNumLevels() const {
+        return this->level_offsets.size() - 1;
+    }
+
+    /**
+     * @brief Get the index of a task
+     * @param task: a task
+     * @return the task's index
+     *
+     * @throw std::invalid_argument
+     */
+    unsigned long DagSnapshot::getIndex(WorkflowTask *task) const {
+        auto it = this->task_indices.find(task);
+        if (it == this->task_indices.end()) {
+            throw std::invalid_argument("DagSnapshot::getIndex(): unknown task");
+        }
+        return it->second;
+    }
+
+    /**
+     * @brief Check whether a task is in the snapshot
+     * @param task: a task
+     * @return true or false
+     */
+    bool DagSnapshot::hasTask(WorkflowTask *task) const {
+        return this->task_indices.find(task) != this->task_indices.end();
+    }
+
+    /**
+     * @brief Get the indices of the tasks in a range of levels
+     * @param start_level: the first level
+     * @param end_level: the last level
+     * @return a vector of task indices
+     */
+    std::vector<unsigned long> DagSnapshot::getIndicesInTopLevelRange(unsigned long start_level,
+                                                                      unsigned long end_level) const {
+        std::vector<unsigned long> indices;
+        if ((start_level > end_level) or (start_level >= this->getNumLevels())) {
+            return indices;
+        }
+        end_level = std::min<unsigned long>(end_level, this->getNumLevels() - 1);
+        for (unsigned long i = this->getLevelBegin(start_level); i < this->getLevelEnd(end_level); i++) {
+            indices.push_back(i);
+        }
+        return indices;
+    }
+
+    /**
+     * @brief Get the tasks that correspond to task indices
+     * @param indices: task indices
+     * @return a vector of tasks
+     */
+    std::vector<WorkflowTask *> DagSnapshot::getTasks(const std::vector<unsigned long> &indices) const {
+        std::vector<WorkflowTask *> tasks;
+        tasks.reserve(indices.size());
+        for (auto i : indices) {
+            tasks.push_back(this->tasks[i]);
+        }
+        return tasks;
+    }
+
+};
@@ -0,0 +1,150 @@
+/**
+ * Copyright (c) 2017. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+
+#ifndef TASK_CLUSTERING_BATCH_SIMULATOR_DAGSNAPSHOT_H
+#define TASK_CLUSTERING_BATCH_SIMULATOR_DAGSNAPSHOT_H
+
+
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+
+namespace wrench {
+
+    class Workflow;
+    class WorkflowTask;
+
+    /**
+     * @brief A read-only, index-based view of a workflow's DAG
+     *
+     * Tasks are numbered densely, level by level (and, within a level, in the order
+     * in which Workflow::getTasks() returns them), so that the tasks
+     * in a range of levels are a contiguous range of indices. Parents and children
+     * are stored in compressed sparse row (CSR) form.
+     *
+     * A snapshot never changes: when the workflow is modified, a new snapshot (with a
+     * higher version) must be built.
+     */
+    class DagSnapshot {
+
+    public:
+
+        explicit DagSnapshot(Workflow *workflow);
+
+        DagSnapshot(Workflow *workflow,
+                    const std::unordered_map<WorkflowTask *, std::vector<WorkflowTask *>> &task_parents,
+                    unsigned long version);
+
+        Workflow *getWorkflow() const;
+
+        unsigned long getVersion() const;
+
+        unsigned long getNumTasks() const;
+
+        unsigned long getNumLevels() const;
+
+        unsigned long getIndex(WorkflowTask *task) const;
+
+        bool hasTask(WorkflowTask *task) const;
+
+        /** @brief Get the task with a given index */
+        WorkflowTask *getTask(unsigned long index) const { return this->tasks[index]; }
+
+        /** @brief Get the flops of the task with a given index */
+        double getFlops(unsigned long index) const { return this->flops[index]; }
+
+        /** @brief Get the top level of the task with a given index */
+        unsigned long getLevel(unsigned long index) const { return this->levels[index]; }
+
+        /** @brief Get a task's random 64-bit key, from which task set fingerprints are computed */
+        uint64_t getTaskKey(unsigned long index) const { return this->task_keys[index]; }
+
+        /** @brief Get the rank of a task in task address order (the estimator's scheduling priority) */
+        unsigned long getPriority(unsigned long index) const { return this->priorities[index]; }
+
+        /** @brief Get the index of the first task in a level */
+        unsigned long getLevelBegin(unsigned long level) const { return this->level_offsets[level]; }
+
+        /** @brief Get one past the index of the last task in a level */
+        unsigned long getLevelEnd(unsigned long level) const { return this->level_offsets[level + 1]; }
+
+        /** @brief Get the number of tasks in a level */
+        unsigned long getNumTasksInLevel(unsigned long level) const {
+            return this->level_offsets[level + 1] - this->level_offsets[level];
+        }
+
+        /** @brief Get the total flops of the tasks in a range of levels */
+        double getLevelRangeFlops(unsigned long start_level, unsigned long end_level) const {
+            return this->level_flops_prefix[end_level + 1] - this->level_flops_prefix[start_level];
+        }
+
+        /** @brief Get a pointer to the first parent index of a task */
+        const unsigned long *getParentsBegin(unsigned long index) const {
+            return this->parent_indices.data() + this->parent_offsets[index];
+        }
+
+        /** @brief Get a pointer one past the last parent index of a task */
+        const unsigned long *getParentsEnd(unsigned long index) const {
+            return this->parent_indices.data() + this->parent_offsets[index + 1];
+        }
+
+        /** @brief Get the number of parents of a task */
+        unsigned long getNumParents(unsigned long index) const {
+            return this->parent_offsets[index + 1] - this->parent_offsets[index];
+        }
+
+        /** @brief Get a pointer to the first child index of a task */
+        const unsigned long *getChildrenBegin(unsigned long index) const {
+            return this->child_indices.data() + this->child_offsets[index];
+        }
+
+        /** @brief Get a pointer one past the last child index of a task */
+        const unsigned long *getChildrenEnd(unsigned long index) const {
+            return this->child_indices.data() + this->child_offsets[index + 1];
+        }
+
+        /** @brief Get the number of children of a task */
+        unsigned long getNumChildren(unsigned long index) const {
+            return this->child_offsets[index + 1] - this->child_offsets[index];
+        }
+
+        std::vector<unsigned long> getIndicesInTopLevelRange(unsigned long start_level, unsigned long end_level) const;
+
+        std::vector<WorkflowTask *> getTasks(const std::vector<unsigned long> &indices) const;
+
+    private:
+
+        void build(const std::unordered_map<WorkflowTask *, std::vector<WorkflowTask *>> &task_parents);
+
+        Workflow *workflow;
+        unsigned long version;
+
+        std::vector<WorkflowTask *> tasks;
+        std::unordered_map<WorkflowTask *, unsigned long> task_indices;
+
+        std::vector<double> flops;
+        std::vector<unsigned long> levels;
+        std::vector<unsigned long> priorities;
+        std::vector<uint64_t> task_keys;
+
+        std::vector<unsigned long> level_offsets;
+        std::vector<double> level_flops_prefix;
+
+        std::vector<unsigned long> parent_offsets;
+        std::vector<unsigned long> parent_indices;
+        std::vector<unsigned long> child_offsets;
+        std::vector<unsigned long> child_indices;
+
+    };
+
+};
+
+
+#endif //TASK_CLUSTERING_BATCH_SIMULATOR_DAGSNAPSHOT_H
@@ -0,0 +1,212 @@
+/**
+ * Copyright (c) 2017. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+#include "IncrementalSchedule.h"
+
+
+namespace wrench {
+
+    /**
+     * @brief Constructor
+     * @param num_hosts: the number of hosts
+     * @param core_speed: the core speed
+     */
+    IncrementalSchedule::IncrementalSchedule(unsigned long num_hosts, double core_speed) {
+        this->num_hosts = num_hosts;
+        this->core_speed = core_speed;
+        this->host_idle_dates.reserve(num_hosts);
+    }
+
+    /**
+     * @brief Tentatively add a task to the schedule, after all the tasks already in it, in O(1). The
+     *        addition must be committed or rolled back before another task is added.
+     * @param flops: the task's flops
+     * @return the schedule's makespan with the task added
+     *
+     * @throw std::runtime_error
+     */
+    double IncrementalSchedule::tryAddTask(double flops) {
+        unsigned long priority = this->tasks.empty() ? 0 : this->tasks.back().first + 1;
+        return this->tryAddTask(flops, priority);
+    }
+
+    /**
+     * @brief Tentatively add a task to the schedule, in O(1) if its priority value is greater than those
+     *        of all the tasks already in it, and in O(n log(num_hosts)) otherwise. The addition must be
+     *        committed or rolled back before another task is added.
+     * @param flops: the task's flops
+     * @param priority: the task's priority (tasks with lower values are scheduled first)
+     * @return the schedule's makespan with the task added
+     *
+     * @throw std::runtime_error
+     */
+    double IncrementalSchedule::tryAddTask(double flops, unsigned long priority) {
+        if (this->num_hosts == 0) {
+            throw std::runtime_error("Cannot estimate makespan with 0 hosts!");
+        }
+        if (this->has_tentative_task) {
+            throw std::runtime_error("IncrementalSchedule::tryAddTask(): a tentative task is pending");
+        }
+        this->has_tentative_task = true;
+        this->tentative_task_priority = priority;
+        this->tentative_task_flops = flops;
+
+        if (this->tasks.empty() or (priority > this->tasks.back().first)) {
+            // Use an idle host if there is one, otherwise the host that becomes idle first
+            this->tentative_task_inserted = false;
+            this->tentative_task_start_date = this->getNextStartDate(this->host_idle_dates);
+            this->tentative_task_end_date = this->tentative_task_start_date + flops / this->core_speed;
+            return std::max<double>(this->makespan, this->tentative_task_end_date);
+        }
+
+        // The task goes before some others: schedule them all again
+        this->tentative_task_inserted = true;
+        this->tentative_host_idle_dates.clear();
+        this->tentative_makespan = 0.0;
+        bool scheduled = false;
+        for (auto const &task : this->tasks) {
+            if ((not scheduled) and (priority < task.first)) {
+                this->scheduleNextTask(this->tentative_host_idle_dates, flops, &this->tentative_makespan);
+                scheduled = true;
+            }
+            this->scheduleNextTask(this->tentative_host_idle_dates, task.second, &this->tentative_makespan);
+        }
+
+        return this->tentative_makespan;
+    }
+
+    /**
+     * @brief Commit the tentatively added task, in O(log(num_hosts)) if it was added after all the tasks
+     *        in the schedule (and in O(n) otherwise)
+     *
+     * @throw std::runtime_error
+     */
+    void IncrementalSchedule::commit() {
+        if (not this->has_tentative_task) {
+            throw std::runtime_error("IncrementalSchedule::commit(): no tentative task");
+        }
+        this->has_tentative_task = false;
+
+        if (this->tentative_task_inserted) {
+            auto position = std::upper_bound(this->tasks.begin(), this->tasks.end(),
+                                             std::make_pair(this->tentative_task_priority, 0.0),
+                                             [](const std::pair<unsigned long, double> &t1,
+                                                const std::pair<unsigned long, double> &t2) -> bool {
+                                                 return t1.first < t2.first;
+                                             });
+            this->tasks.insert(position, std::make_pair(this->tentative_task_priority, this->tentative_task_flops));
+            this->host_idle_dates.swap(this->tentative_host_idle_dates);
+            this->makespan = this->tentative_makespan;
+            return;
+        }
+
+        this->tasks.push_back(std::make_pair(this->tentative_task_priority, this->tentative_task_flops));
+        this->makespan = std::max<double>(this->makespan, this->tentative_task_end_date);
+        this->holdHost(this->host_idle_dates, this->tentative_task_start_date, this->tentative_task_end_date);
+    }
+
+    /**
+     * @brief Forget the tentatively added task
+     */
+    void IncrementalSchedule::rollback() {
+        this->has_tentative_task = false;
+    }
+
+    /**
+     * @brief Add a task to the schedule, after all the tasks already in it
+     * @param flops: the task's flops
+     * @return the schedule's new makespan
+     */
+    double IncrementalSchedule::addTask(double flops) {
+        double new_makespan = this->tryAddTask(flops);
+        this->commit();
+        return new_makespan;
+    }
+
+    /**
+     * @brief Add a task to the schedule
+     * @param flops: the task's flops
+     * @param priority: the task's priority (tasks with lower values are scheduled first)
+     * @return the schedule's new makespan
+     */
+    double IncrementalSchedule::addTask(double flops, unsigned long priority) {
+        double new_makespan = this->tryAddTask(flops, priority);
+        this->commit();
+        return new_makespan;
+    }
+
+    /**
+     * @brief Get the date at which the next task would start
+     * @param host_idle_dates: the dates at which busy hosts become idle, as a min-heap
+     * @return a date
+     */
+    double IncrementalSchedule::getNextStartDate(const std::vector<double> &host_idle_dates) const {
+        if (host_idle_dates.size() < this->num_hosts) {
+            return 0.0;
+        }
+        return host_idle_dates.front();
+    }
+
+    /**
+     * @brief Record that a task holds the host that becomes idle first
+     * @param host_idle_dates: the dates at which busy hosts become idle, as a min-heap
+     * @param start_date: the task's start date
+     * @param end_date: the task's end date
+     */
+    void IncrementalSchedule::holdHost(std::vector<double> &host_idle_dates, double start_date,
+                                       double end_date) const {
+        // A zero-duration task does not hold its host
+        if (end_date <= start_date) {
+            return;
+        }
+
+        if (host_idle_dates.size() == this->num_hosts) {
+            std::pop_heap(host_idle_dates.begin(), host_idle_dates.end(), std::greater<double>());
+            host_idle_dates.pop_back();
+        }
+        host_idle_dates.push_back(end_date);
+        std::push_heap(host_idle_dates.begin(), host_idle_dates.end(), std::greater<double>());
+    }
+
+    /**
+     * @brief Schedule a task after all the others
+     * @param host_idle_dates: the dates at which busy hosts become idle, as a min-heap
+     * @param flops: the task's flops
+     * @param makespan: the makespan, updated
+     */
+    void IncrementalSchedule::scheduleNextTask(std::vector<double> &host_idle_dates, double flops,
+                                               double *makespan) const {
+        double start_date = this->getNextStartDate(host_idle_dates);
+        double end_date = start_date + flops / this->core_speed;
+        *makespan = std::max<double>(*makespan, end_date);
+        this->holdHost(host_idle_dates, start_date, end_date);
+    }
+
+    /**
+     * @brief Get the schedule's makespan (excluding any tentative task)
+     * @return a makespan
+     */
+    double IncrementalSchedule::getMakespan() const {
+        return this->makespan;
+    }
+
+    /**
+     * @brief Get the number of tasks in the schedule (excluding any tentative task)
+     * @return a number of tasks
+     */
+    unsigned long IncrementalSchedule::getNumTasks() const {
+        return this->tasks.size();
+    }
+
+};
@@ -0,0 +1,90 @@
+/**
+ * Copyright (c) 2017. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+
+#ifndef TASK_CLUSTERING_BATCH_SIMULATOR_INCREMENTALSCHEDULE_H
+#define TASK_CLUSTERING_BATCH_SIMULATOR_INCREMENTALSCHEDULE_H
+
+
+#include <utility>
+#include <vector>
+
+namespace wrench {
+
+    /**
+     * @brief A list schedule of independent tasks (e.g., tasks in the same workflow level) on
+     *        identical hosts, built one task at a time: each task is started on the host that
+     *        becomes idle first, in priority order (by default, the order in which tasks are added)
+     *
+     * A task can be tentatively added to see the resulting makespan, and that addition then
+     * committed or rolled back. Adding a task with a lower priority than that of a task already
+     * in the schedule re-simulates the whole schedule; otherwise, it costs O(1).
+     *
+     * With DagSnapshot::getPriority() priorities, makespans are those that
+     * WorkflowUtil::estimateMakespan() computes for the same tasks.
+     */
+    class IncrementalSchedule {
+
+    public:
+
+        IncrementalSchedule(unsigned long num_hosts, double core_speed);
+
+        double tryAddTask(double flops);
+
+        double tryAddTask(double flops, unsigned long priority);
+
+        void commit();
+
+        void rollback();
+
+        double addTask(double flops);
+
+        double addTask(double flops, unsigned long priority);
+
+        double getMakespan() const;
+
+        unsigned long getNumTasks() const;
+
+    private:
+
+        double getNextStartDate(const std::vector<double> &host_idle_dates) const;
+
+        void holdHost(std::vector<double> &host_idle_dates, double start_date, double end_date) const;
+
+        void scheduleNextTask(std::vector<double> &host_idle_dates, double flops, double *makespan) const;
+
+        unsigned long num_hosts;
+        double core_speed;
+
+        // Dates at which busy hosts become idle, as a min-heap
+        std::vector<double> host_idle_dates;
+
+        // (priority, flops) of each task, by increasing priority value (i.e., decreasing priority)
+        std::vector<std::pair<unsigned long, double>> tasks;
+
+        double makespan = 0.0;
+
+        bool has_tentative_task = false;
+        unsigned long tentative_task_priority = 0;
+        double tentative_task_flops = 0.0;
+        double tentative_task_start_date = 0.0;
+        double tentative_task_end_date = 0.0;
+
+        // Whether the tentative task is scheduled before some other tasks, in which case the
+        // schedule with it is fully re-simulated into the following
+        bool tentative_task_inserted = false;
+        std::vector<double> tentative_host_idle_dates;
+        double tentative_makespan = 0.0;
+
+    };
+
+};
+
+
+#endif //TASK_CLUSTERING_BATCH_SIMULATOR_INCREMENTALSCHEDULE_H
@@ -0,0 +1,126 @@
+/**
+ * Copyright (c) 2017. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+
+#include <wrench-dev.h>
+
+#include "LeewaySolver.h"
+#include "ProxyWMS.h"
+#include "QueryProfiler.h"
+
+
+namespace wrench {
+
+    constexpr double LeewaySolver::LEEWAY_TOLERANCE;
+
+    /**
+     * @brief Constructor
+     * @param proxy_wms: the proxy WMS used to estimate wait times
+     * @param sequence: the counter used to make estimate request keys unique
+     * @param num_probes_per_round: the number of leeways probed in each round of the bracketed search
+     *
+     * @throw std::invalid_argument
+     */
+    LeewaySolver::LeewaySolver(ProxyWMS *proxy_wms, int *sequence, unsigned long num_probes_per_round) {
+        if ((proxy_wms == nullptr) or (sequence == nullptr) or (num_probes_per_round == 0)) {
+            throw std::invalid_argument("LeewaySolver::LeewaySolver(): invalid arguments");
+        }
+        this->proxy_wms = proxy_wms;
+        this->sequence = sequence;
+        this->num_probes_per_round = num_probes_per_round;
+    }
+
+    /**
+     * @brief Find a leeway in [lower, upper] with a k-ary bracketed search: each round probes k evenly
+     *        spaced leeways (k = num_probes_per_round) and returns the smallest one that yields a full
+     *        overlap with the parent job, or narrows the bracket to between the largest probe whose job
+     *        would start too early and the next probe. With k = 1, this is a binary search.
+     * @param runtime: the job's execution time
+     * @param num_nodes: the job's number of nodes
+     * @param parent_runtime: the time until the parent job completes
+     * @param lower: the smallest leeway
+     * @param upper: the largest leeway
+     * @param simulation_date: the current simulation date
+     * @return a leeway (upper, if the bracket becomes narrower than the tolerance)
+     */
+    double LeewaySolver::findLeeway(double runtime, unsigned long num_nodes, double parent_runtime,
+                                    double lower, double upper, double simulation_date) {
+        QueryProfiler::Phase phase("leeway");
+
+        while ((upper - lower) >= LEEWAY_TOLERANCE) {
+
+            std::vector<double> leeways;
+            std::vector<std::pair<unsigned long, double>> configurations;
+            for (unsigned long i = 1; i <= this->num_probes_per_round; i++) {
+                double leeway = floor(lower + i * (upper - lower) / (this->num_probes_per_round + 1));
+                leeways.push_back(leeway);
+                configurations.push_back(std::make_pair(num_nodes, runtime + leeway));
+            }
+            std::vector<double> wait_times = this->proxy_wms->estimateWaitTimes(configurations, simulation_date,
+                                                                                this->sequence);
+
+            double new_lower = lower;
+            double new_upper = upper;
+            for (unsigned long i = 0; i < leeways.size(); i++) {
+                double remaining_leeway = parent_runtime - wait_times[i];
+                if (remaining_leeway >= LEEWAY_TOLERANCE) {
+                    // not enough overlap :(
+                    new_lower = leeways[i] + 1;
+                } else if (remaining_leeway < 0) {
+                    // too much: the job would start after its parent completes
+                    new_upper = leeways[i] - 1;
+                    break;
+                } else {
+                    // enough to create full overlap + (some slack < 10 minutes)
+                    return leeways[i];
+                }
+            }
+            lower = new_lower;
+            upper = new_upper;
+        }
+
+        return upper;
+    }
+
+    /**
+     * @brief Find a leeway with Zhang's one-way search: starting from the time between the job's
+     *        estimated start and the parent job's completion, halve the leeway for as long as it is
+     *        above the tolerance and half of it would still make the job start after its parent
+     *        completes. All the halvings are probed in one request.
+     * @param wait_time: the job's estimated wait time without leeway
+     * @param runtime: the job's execution time
+     * @param num_nodes: the job's number of nodes
+     * @param parent_runtime: the time until the parent job completes
+     * @param simulation_date: the current simulation date
+     * @return a leeway
+     */
+    double LeewaySolver::findLeewayByHalving(double wait_time, double runtime, unsigned long num_nodes,
+                                             double parent_runtime, double simulation_date) {
+        QueryProfiler::Phase phase("leeway");
+        std::vector<double> leeways;
+        std::vector<std::pair<unsigned long, double>> configurations;
+        for (double leeway = parent_runtime - wait_time; leeway > LEEWAY_TOLERANCE; leeway /= 2.0) {
+            leeways.push_back(leeway);
+            configurations.push_back(std::make_pair(num_nodes, runtime + leeway / 2.0));
+        }
+        std::vector<double> wait_times = this->proxy_wms->estimateWaitTimes(configurations, simulation_date,
+                                                                            this->sequence);
+
+        double leeway = parent_runtime - wait_time;
+        for (unsigned long i = 0; i < leeways.size(); i++) {
+            if (wait_times[i] <= parent_runtime) {
+                break;
+            }
+            leeway = leeways[i] / 2.0;
+        }
+
+        return leeway;
+    }
+
+};
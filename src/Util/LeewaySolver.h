@@ -0,0 +1,52 @@
+/**
+ * Copyright (c) 2017. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+
+#ifndef TASK_CLUSTERING_BATCH_SIMULATOR_LEEWAYSOLVER_H
+#define TASK_CLUSTERING_BATCH_SIMULATOR_LEEWAYSOLVER_H
+
+
+namespace wrench {
+
+    class ProxyWMS;
+
+    /**
+     * @brief Finds the leeway (extra requested execution time) with which a job submitted now
+     *        would start about when a parent job completes, i.e., at most LEEWAY_TOLERANCE seconds
+     *        before (and never after) it
+     *
+     * All the wait times that a search round needs are estimated with a single batched request.
+     */
+    class LeewaySolver {
+
+    public:
+
+        /** @brief The tolerance, in seconds, on the overlap with the parent job */
+        static constexpr double LEEWAY_TOLERANCE = 600.0;
+
+        LeewaySolver(ProxyWMS *proxy_wms, int *sequence, unsigned long num_probes_per_round = 7);
+
+        double findLeeway(double runtime, unsigned long num_nodes, double parent_runtime,
+                          double lower, double upper, double simulation_date);
+
+        double findLeewayByHalving(double wait_time, double runtime, unsigned long num_nodes,
+                                   double parent_runtime, double simulation_date);
+
+    private:
+
+        ProxyWMS *proxy_wms;
+        int *sequence;
+        unsigned long num_probes_per_round;
+
+    };
+
+};
+
+
+#endif //TASK_CLUSTERING_BATCH_SIMULATOR_LEEWAYSOLVER_H
@@ -0,0 +1,324 @@
+/**
+ * Copyright (c) 2019. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <Util/LevelGroupingWMS.h>
+#include <Util/WorkflowUtil.h>
+#include <Util/DagSnapshot.h>
+#include "Globals.h"
+
+XBT_LOG_NEW_DEFAULT_CATEGORY(level_grouping_wms, "Log category for Level Grouping WMS");
+
+namespace wrench {
+
+    LevelGroupingWMS::LevelGroupingWMS(Simulator *simulator, std::string hostname, double waste_bound,
+                                       bool use_wait_time_surface,
+                                       std::shared_ptr<BatchComputeService> batch_service) :
+            WMS(nullptr, nullptr, {batch_service}, {}, {}, nullptr, hostname, "clustering_wms") {
+        this->simulator = simulator;
+        this->waste_bound = waste_bound;
+        this->use_wait_time_surface = use_wait_time_surface;
+        this->batch_service = batch_service;
+        this->pending_placeholder_job = nullptr;
+        this->number_of_splits = 0;
+        this->sequence = 0;
+    }
+
+    int LevelGroupingWMS::main() {
+
+        TerminalOutput::setThisProcessLoggingColor(TerminalOutput::COLOR_WHITE);
+
+        this->checkDeferredStart();
+
+        this->core_speed = (*(this->batch_service->getCoreFlopRate().begin())).second;
+        this->number_of_hosts = this->batch_service->getNumHosts();
+        this->job_manager = this->createJobManager();
+        this->proxyWMS = new ProxyWMS(this->getWorkflow(), this->job_manager, this->batch_service,
+                                      this->simulator->wait_time_predictor);
+        this->leeway_solver = new LeewaySolver(this->proxyWMS, &this->sequence);
+
+        Globals::sim_json["end_levels"] = std::vector<unsigned long> ();
+
+        while (not this->getWorkflow()->isDone()) {
+            applyGroupingHeuristic();
+            this->waitForAndProcessNextEvent();
+            // The event may have changed the batch queue
+            this->proxyWMS->clearStartTimeEstimates();
+        }
+
+        WRENCH_INFO("#SPLITS= %lu", this->number_of_splits);
+
+        Globals::sim_json["num_splits"] = this->number_of_splits;
+        this->reportStatistics();
+
+        return 0;
+    }
+
+    /**
+     * @brief Write algorithm-specific statistics to the JSON output once the workflow is done
+     */
+    void LevelGroupingWMS::reportStatistics() {
+    }
+
+    unsigned long LevelGroupingWMS::findMaxParallelism(unsigned long start_level, unsigned long end_level) {
+        unsigned long max_parallelism = 0;
+        for (unsigned long i = start_level; i <= end_level; i++) {
+            unsigned long num_tasks_in_level = WorkflowUtil::getDagSnapshot(this->getWorkflow())->getNumTasksInLevel(i);
+            max_parallelism = std::max<unsigned long>(max_parallelism, num_tasks_in_level);
+        }
+
+        return std::min<unsigned long>(max_parallelism, this->number_of_hosts);
+    }
+
+    bool LevelGroupingWMS::isTooWasteful(double runtime, unsigned long nodes, unsigned long start_level,
+                                          unsigned long end_level) {
+        // From the snapshot's per-level flops prefix sums, which, like the makespan estimates that it is
+        // compared to, count completed tasks
+        double all_tasks_time = WorkflowUtil::getDagSnapshot(this->getWorkflow())->getLevelRangeFlops(
+                start_level, end_level) / this->core_speed;
+
+        double waste_ratio = (nodes * runtime - all_tasks_time) / (nodes * runtime);
+
+        return waste_ratio > this->waste_bound;
+    }
+
+    void LevelGroupingWMS::processEventPilotJobStart(std::shared_ptr<PilotJobStartedEvent> e) {
+        // Update queue waiting time
+        this->simulator->total_queue_wait_time +=
+                this->simulation->getCurrentSimulatedDate() - e->pilot_job->getSubmitDate();
+
+        WRENCH_INFO("Got a Pilot Job Start event: %s", e->pilot_job->getName().c_str());
+
+        if (this->pending_placeholder_job == nullptr) {
+            throw std::runtime_error("Fatal Error: couldn't find a placeholder job for a pilob job that just started");
+        }
+
+        WRENCH_INFO("Got a Pilot Job Start event e->pilot_job = %ld, this->pending->pilot_job = %ld (%s)",
+                    (unsigned long) e->pilot_job.get(),
+                    (unsigned long) this->pending_placeholder_job->pilot_job.get(),
+                    this->pending_placeholder_job->pilot_job->getName().c_str());
+
+        if (e->pilot_job != this->pending_placeholder_job->pilot_job) {
+            // hmm
+            WRENCH_INFO("Must be for a placeholder I already cancelled... nevermind");
+            return;
+        }
+
+        PlaceHolderJob *placeholder_job = this->pending_placeholder_job;
+        this->running_placeholder_jobs.insert(placeholder_job);
+        this->placeholder_registry.add(placeholder_job);
+        this->pending_placeholder_job = nullptr;
+
+        placeholder_job->initializeReadyQueue(this->getWorkflow(), this->placeholder_registry.getCompletedTasks());
+
+        // std::string output_string = "";
+
+        while (placeholder_job->num_standard_job_submitted < placeholder_job->num_hosts) {
+            WorkflowTask *task = placeholder_job->popReadyTask();
+            if (task == nullptr) {
+                break;
+            }
+            if (task->getState() != WorkflowTask::State::READY) {
+                // Already submitted
+                continue;
+            }
+            auto standard_job = this->job_manager->createStandardJob(task, {});
+
+            // output_string += " " + task->getID();
+
+            WRENCH_INFO("Submitting task %s as part of placeholder job %ld-%ld",
+                        task->getID().c_str(), placeholder_job->start_level, placeholder_job->end_level);
+            this->job_manager->submitJob(standard_job, placeholder_job->pilot_job->getComputeService());
+            placeholder_job->num_standard_job_submitted++;
+        }
+
+        this->applyGroupingHeuristic();
+    }
+
+    void LevelGroupingWMS::processEventPilotJobExpiration(std::shared_ptr<PilotJobExpiredEvent> e) {
+        PlaceHolderJob *placeholder_job = this->placeholder_registry.getPlaceholderJob(e->pilot_job.get());
+
+        if (placeholder_job == nullptr) {
+            throw std::runtime_error("Got a pilot job expiration, but no matching placeholder job found");
+        }
+
+        this->running_placeholder_jobs.erase(placeholder_job);
+        this->placeholder_registry.remove(placeholder_job);
+        this->proxyWMS->notifyJobTermination(e->pilot_job.get());
+
+        WRENCH_INFO("Got a pilot job expiration for a placeholder job that deals with levels %ld-%ld (%s)",
+                    placeholder_job->start_level, placeholder_job->end_level,
+                    placeholder_job->pilot_job->getName().c_str());
+
+        // Check if there are unprocessed tasks
+        bool unprocessed = false;
+        for (auto t : placeholder_job->tasks) {
+            if (t->getState() != WorkflowTask::COMPLETED) {
+                unprocessed = true;
+                break;
+            }
+        }
+
+        unsigned long num_used_nodes;
+        sscanf(e->pilot_job->getServiceSpecificArguments()["-N"].c_str(), "%lu", &num_used_nodes);
+
+        unsigned long num_used_minutes;
+        sscanf(e->pilot_job->getServiceSpecificArguments()["-t"].c_str(), "%lu", &num_used_minutes);
+
+        double wasted_node_seconds = 60.0 * num_used_minutes * num_used_nodes;
+
+        for (auto t : placeholder_job->tasks) {
+            if (t->getState() == WorkflowTask::State::COMPLETED) {
+                wasted_node_seconds -= t->getFlops() / this->core_speed;
+            }
+        }
+        this->simulator->wasted_node_seconds += wasted_node_seconds;
+
+        if (not unprocessed) {
+            // Nothing to do
+            WRENCH_INFO("This placeholder job has no unprocessed tasks. great.");
+            return;
+        }
+
+        this->simulator->num_pilot_job_expirations_with_remaining_tasks_to_do++;
+
+        WRENCH_INFO("This placeholder job has unprocessed tasks");
+
+        if (this->pending_placeholder_job) {
+            // Cancel pending pilot job if any
+            WRENCH_INFO("Canceling pending placeholder job (placeholder=%ld,  pilot_job=%ld / %s",
+                        (unsigned long) this->pending_placeholder_job,
+                        (unsigned long) this->pending_placeholder_job->pilot_job.get(),
+                        this->pending_placeholder_job->pilot_job->getName().c_str());
+            this->proxyWMS->terminateJob(this->pending_placeholder_job->pilot_job);
+            this->pending_placeholder_job = nullptr;
+        }
+
+        // Cancel running pilot jobs if none of their tasks has started
+
+        std::set<PlaceHolderJob *> to_remove;
+        for (auto ph : this->running_placeholder_jobs) {
+            bool started = false;
+            for (auto task : ph->tasks) {
+                if (task->getState() != WorkflowTask::State::NOT_READY) {
+                    started = true;
+                }
+            }
+            if (not started) {
+                // hmm
+                WRENCH_INFO("Canceling running placeholder job that handled levels %ld-%ld because none"
+                            "of its tasks has started (%s)", ph->start_level, ph->end_level,
+                            ph->pilot_job->getName().c_str());
+                try {
+                    this->proxyWMS->terminateJob(ph->pilot_job);
+                } catch (WorkflowExecutionException &e) {
+                    // ignore (likely already dead!)
+                }
+                to_remove.insert(ph);
+            }
+        }
+
+        for (auto ph : to_remove) {
+            this->running_placeholder_jobs.erase(ph);
+            this->placeholder_registry.remove(ph);
+        }
+
+        this->applyGroupingHeuristic();
+    }
+
+    void LevelGroupingWMS::processEventStandardJobCompletion(std::shared_ptr<StandardJobCompletedEvent> e) {
+        // only one task per job
+        WorkflowTask *completed_task = e->standard_job->tasks[0];
+
+        WRENCH_INFO("Got a standard job completion for task %s", completed_task->getID().c_str());
+
+        this->simulator->used_node_seconds += completed_task->getFlops() / this->core_speed;
+
+        // Find the placeholder job this task belongs to
+        PlaceHolderJob *placeholder_job = this->placeholder_registry.getPlaceholderJob(completed_task);
+
+        // Queue the tasks, in running placeholder jobs, whose last uncompleted parent was the completed task
+        this->placeholder_registry.notifyTaskCompletion(completed_task, this->getWorkflow());
+
+        if (placeholder_job != nullptr) {
+
+            placeholder_job->num_standard_job_submitted--;
+
+            // Terminate the pilot job in case all its tasks are done
+            bool all_tasks_done = true;
+            for (auto t : placeholder_job->tasks) {
+                if (t->getState() != WorkflowTask::COMPLETED) {
+                    all_tasks_done = false;
+                    break;
+                }
+            }
+            if (all_tasks_done) {
+                // Update the wasted no seconds metric
+                double first_task_start_time = DBL_MAX;
+                for (auto const &t : placeholder_job->tasks) {
+                    if (t->getStartDate() < first_task_start_time) {
+                        first_task_start_time = t->getStartDate();
+                    }
+                }
+                int num_requested_nodes = stoi(placeholder_job->pilot_job->getServiceSpecificArguments()["-N"]);
+                double job_duration = this->simulation->getCurrentSimulatedDate() - first_task_start_time;
+                double wasted_node_seconds = num_requested_nodes * job_duration;
+                for (auto const &t : placeholder_job->tasks) {
+                    wasted_node_seconds -= t->getFlops() / this->core_speed;
+                }
+
+                this->simulator->wasted_node_seconds += wasted_node_seconds;
+
+                WRENCH_INFO("All tasks are completed in this placeholder job, so I am terminating it (%s)",
+                            placeholder_job->pilot_job->getName().c_str());
+                try {
+                    // hmm
+                    WRENCH_INFO("TERMINATING A PILOT JOB");
+                    this->proxyWMS->terminateJob(placeholder_job->pilot_job);
+                } catch (WorkflowExecutionException &e) {
+                    // ignore
+                }
+                this->running_placeholder_jobs.erase(placeholder_job);
+                this->placeholder_registry.remove(placeholder_job);
+            }
+        }
+
+        // Start all newly ready tasks that depended on the completed task, IN ANY PLACEHOLDER,
+        // considering first tasks at the same level of completed_task
+        for (auto ph : this->running_placeholder_jobs) {
+            while (ph->num_standard_job_submitted < ph->num_hosts) {
+                WorkflowTask *task = ph->popReadyTask(completed_task->getTopLevel());
+                if (task == nullptr) {
+                    task = ph->popReadyTask();
+                }
+                if (task == nullptr) {
+                    break;
+                }
+                if (task->getState() != WorkflowTask::READY) {
+                    // Already submitted
+                    continue;
+                }
+
+                auto standard_job = this->job_manager->createStandardJob(task, {});
+                WRENCH_INFO("Submitting task %s  as part of placeholder job %ld-%ld",
+                            task->getID().c_str(), ph->start_level, ph->end_level);
+                this->job_manager->submitJob(standard_job, ph->pilot_job->getComputeService());
+
+                ph->num_standard_job_submitted++;
+            }
+        }
+    }
+
+    void LevelGroupingWMS::processEventStandardJobFailure(std::shared_ptr<StandardJobFailedEvent> e) {
+        WRENCH_INFO("Got a standard job failure event for task %s -- IGNORING THIS",
+                    e->standard_job->tasks[0]->getID().c_str());
+        throw std::runtime_error("A job has failed, which shouldn't happen");
+    }
+
+
+};
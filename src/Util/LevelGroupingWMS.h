@@ -0,0 +1,90 @@
+/**
+ * Copyright (c) 2019. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+
+#ifndef TASK_CLUSTERING_BATCH_SIMULATOR_LEVELGROUPINGWMS_H
+#define TASK_CLUSTERING_BATCH_SIMULATOR_LEVELGROUPINGWMS_H
+
+
+#include <wrench-dev.h>
+#include "Simulator.h"
+#include <Util/PlaceHolderJob.h>
+#include <Util/ProxyWMS.h>
+#include <Util/LeewaySolver.h>
+#include <Util/PlaceholderRegistry.h>
+
+namespace wrench {
+
+    /**
+     * @brief A WMS that runs the workflow as a sequence of placeholder jobs, each for a range of
+     *        consecutive levels, that a grouping heuristic submits one at a time (the next one
+     *        once the previous one has started)
+     *
+     * Subclasses only implement the grouping heuristic: this class runs the tasks in the placeholder
+     * jobs, and handles pilot job expirations by cancelling the placeholder jobs that have not
+     * started any task yet and grouping the remaining levels again.
+     */
+    class LevelGroupingWMS : public WMS {
+
+    public:
+
+        LevelGroupingWMS(Simulator *simulator, std::string hostname, double waste_bound,
+                         bool use_wait_time_surface, std::shared_ptr<BatchComputeService> batch_service);
+
+    protected:
+
+        /** @brief Submit the next placeholder job, unless one is pending */
+        virtual void applyGroupingHeuristic() = 0;
+
+        virtual void reportStatistics();
+
+        unsigned long findMaxParallelism(unsigned long start_level, unsigned long end_level);
+
+        bool isTooWasteful(double runtime, unsigned long nodes, unsigned long start_level,
+                           unsigned long end_level);
+
+        Simulator *simulator;
+        std::shared_ptr<BatchComputeService> batch_service;
+
+        double waste_bound;
+        bool use_wait_time_surface;
+
+        std::set<PlaceHolderJob *> running_placeholder_jobs;
+        PlaceholderRegistry placeholder_registry;
+        PlaceHolderJob *pending_placeholder_job;
+        double core_speed;
+        unsigned long number_of_hosts;
+        std::shared_ptr<JobManager> job_manager;
+
+        ProxyWMS *proxyWMS;
+        LeewaySolver *leeway_solver;
+
+        // The counter used to make the keys of wait time estimate requests unique
+        int sequence;
+
+        unsigned long number_of_splits;
+
+    private:
+
+        int main() override;
+
+        void processEventPilotJobStart(std::shared_ptr<PilotJobStartedEvent> e) override;
+
+        void processEventPilotJobExpiration(std::shared_ptr<PilotJobExpiredEvent> e) override;
+
+        void processEventStandardJobCompletion(std::shared_ptr<StandardJobCompletedEvent> e) override;
+
+        void processEventStandardJobFailure(std::shared_ptr<StandardJobFailedEvent> e) override;
+
+    };
+
+};
+
+
+#endif //TASK_CLUSTERING_BATCH_SIMULATOR_LEVELGROUPINGWMS_H
@@ -0,0 +1,261 @@
+/**
+ * Copyright (c) 2017. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+#include "LevelRangeSchedule.h"
+#include "DagSnapshot.h"
+
+
+namespace wrench {
+
+    /**
+     * @brief Constructor
+     * @param dag: the workflow's DAG snapshot
+     * @param start_level: the first level
+     * @param end_level: the last level (no lower than start_level)
+     * @param num_hosts: a (non-zero) number of hosts
+     * @param core_speed: the core speed
+     *
+     * @throw std::invalid_argument
+     * @throw std::runtime_error
+     */
+    LevelRangeSchedule::LevelRangeSchedule(std::shared_ptr<DagSnapshot> dag, unsigned long start_level,
+                                           unsigned long end_level, unsigned long num_hosts, double core_speed) {
+        if ((dag == nullptr) or (start_level > end_level) or (end_level >= dag->getNumLevels())) {
+            throw std::invalid_argument("LevelRangeSchedule::LevelRangeSchedule(): invalid level range");
+        }
+        if (num_hosts == 0) {
+            throw std::runtime_error("Cannot estimate makespan with 0 hosts!");
+        }
+        this->dag = dag;
+        this->start_level = start_level;
+        this->end_level = end_level;
+        this->num_hosts = num_hosts;
+        this->core_speed = core_speed;
+        this->first_task = dag->getLevelBegin(start_level);
+
+        unsigned long num_tasks = dag->getLevelEnd(end_level) - this->first_task;
+        this->start_dates.assign(num_tasks, -1.0);
+        this->end_dates.assign(num_tasks, -1.0);
+        this->run(0.0, 0);
+    }
+
+    /**
+     * @brief Extend the schedule to more levels
+     * @param end_level: the new last level (no lower than the current one)
+     *
+     * @throw std::invalid_argument
+     */
+    void LevelRangeSchedule::extendTo(unsigned long end_level) {
+        if ((end_level < this->end_level) or (end_level >= this->dag->getNumLevels())) {
+            throw std::invalid_argument("LevelRangeSchedule::extendTo(): invalid level");
+        }
+        if (end_level == this->end_level) {
+            return;
+        }
+
+        // The tasks of the first added level have all their parents in the range (or before it), so
+        // none of the added tasks can become ready before one of them does
+        unsigned long num_previous_tasks = this->start_dates.size();
+        double resume_date = -1.0;
+        for (unsigned long i = this->dag->getLevelBegin(this->end_level + 1);
+             i < this->dag->getLevelEnd(this->end_level + 1); i++) {
+            double ready_date = 0.0;
+            for (auto parent = this->dag->getParentsBegin(i); parent != this->dag->getParentsEnd(i); parent++) {
+                if (*parent >= this->first_task) {
+                    ready_date = std::max<double>(ready_date, this->end_dates[*parent - this->first_task]);
+                }
+            }
+            resume_date = (resume_date < 0) ? ready_date : std::min<double>(resume_date, ready_date);
+        }
+
+        this->end_level = end_level;
+        unsigned long num_tasks = this->dag->getLevelEnd(end_level) - this->first_task;
+        this->start_dates.resize(num_tasks, -1.0);
+        this->end_dates.resize(num_tasks, -1.0);
+        this->run(std::max<double>(0.0, resume_date), num_previous_tasks);
+    }
+
+    /**
+     * @brief Get the last level of the range
+     * @return a level
+     */
+    unsigned long LevelRangeSchedule::getEndLevel() const {
+        return this->end_level;
+    }
+
+    /**
+     * @brief Get the number of hosts
+     * @return a number of hosts
+     */
+    unsigned long LevelRangeSchedule::getNumHosts() const {
+        return this->num_hosts;
+    }
+
+    /**
+     * @brief Get the makespan of the schedule
+     * @return a makespan
+     */
+    double LevelRangeSchedule::getMakespan() const {
+        return this->prefix_makespans.empty() ? 0.0 : this->prefix_makespans.back();
+    }
+
+    /**
+     * @brief Discard the part of the schedule from a date on, and re-simulate it (with the same greedy
+     *        list scheduling as WorkflowUtil::estimateMakespan())
+     * @param resume_date: a task completion date (or zero), before which no task that was not started
+     *        can become ready
+     * @param num_previous_tasks: the number of tasks that were in the range before it was extended
+     *
+     * @throw std::runtime_error
+     */
+    void LevelRangeSchedule::run(double resume_date, unsigned long num_previous_tasks) {
+        unsigned long num_tasks = this->start_dates.size();
+
+        // Un-start the tasks started from the resume date on
+        unsigned long num_kept_tasks = std::partition_point(
+                this->started_tasks.begin(), this->started_tasks.end(),
+                [this, resume_date](unsigned long task) { return this->start_dates[task] < resume_date; }) -
+                                       this->started_tasks.begin();
+        std::vector<unsigned long> &unstarted_tasks = this->unstarted_tasks;
+        unstarted_tasks.assign(this->started_tasks.begin() + num_kept_tasks, this->started_tasks.end());
+        for (unsigned long task = num_previous_tasks; task < num_tasks; task++) {
+            unstarted_tasks.push_back(task);
+        }
+        for (auto task : unstarted_tasks) {
+            if (this->end_dates[task] > this->start_dates[task]) {
+                this->tasks_by_end_date.erase(std::make_pair(this->end_dates[task], task));
+            }
+            this->start_dates[task] = -1.0;
+            this->end_dates[task] = -1.0;
+        }
+        this->started_tasks.resize(num_kept_tasks);
+        this->prefix_makespans.resize(num_kept_tasks);
+
+        // Rebuild the state of the list schedule at the resume date: tasks that complete then or later
+        // are running, and a task is ready once all its (in-range) parents completed before then
+        std::vector<unsigned long> &num_pending_parents = this->num_pending_parents;
+        num_pending_parents.resize(num_tasks);
+        std::vector<std::pair<unsigned long, unsigned long>> &ready_tasks = this->ready_tasks;
+        ready_tasks.clear();
+        auto ready_cmp = std::greater<std::pair<unsigned long, unsigned long>>();
+        for (auto task : unstarted_tasks) {
+            num_pending_parents[task] = 0;
+            for (auto parent = this->dag->getParentsBegin(this->first_task + task);
+                 parent != this->dag->getParentsEnd(this->first_task + task); parent++) {
+                if ((*parent >= this->first_task) and
+                    ((this->start_dates[*parent - this->first_task] < 0) or
+                     (this->end_dates[*parent - this->first_task] >= resume_date))) {
+                    num_pending_parents[task]++;
+                }
+            }
+            if (num_pending_parents[task] == 0) {
+                ready_tasks.push_back(std::make_pair(this->dag->getPriority(this->first_task + task), task));
+            }
+        }
+        std::make_heap(ready_tasks.begin(), ready_tasks.end(), ready_cmp);
+
+        std::vector<std::pair<double, unsigned long>> &running_tasks = this->running_tasks;
+        auto running_cmp = std::greater<std::pair<double, unsigned long>>();
+        running_tasks.assign(this->tasks_by_end_date.lower_bound(std::make_pair(resume_date, 0UL)),
+                             this->tasks_by_end_date.end());
+        std::make_heap(running_tasks.begin(), running_tasks.end(), running_cmp);
+
+        std::vector<unsigned long> &deferred_tasks = this->deferred_tasks;
+        deferred_tasks.clear();
+
+        auto push_ready_task = [this, &ready_tasks, &ready_cmp](unsigned long task) {
+            ready_tasks.push_back(std::make_pair(this->dag->getPriority(this->first_task + task), task));
+            std::push_heap(ready_tasks.begin(), ready_tasks.end(), ready_cmp);
+        };
+
+        unsigned long num_idle_hosts = this->num_hosts - running_tasks.size();
+        unsigned long num_scheduled_tasks = num_kept_tasks;
+        unsigned long last_task = this->first_task + num_tasks;
+        double current_time = resume_date;
+        double makespan = (num_kept_tasks > 0) ? this->prefix_makespans.back() : 0.0;
+
+        while (true) {
+
+            // Release the children of all tasks that complete by the current date
+            while ((not running_tasks.empty()) and (running_tasks.front().first <= current_time)) {
+                unsigned long task = running_tasks.front().second;
+                std::pop_heap(running_tasks.begin(), running_tasks.end(), running_cmp);
+                running_tasks.pop_back();
+                num_idle_hosts++;
+                for (auto c = this->dag->getChildrenBegin(this->first_task + task);
+                     c != this->dag->getChildrenEnd(this->first_task + task); c++) {
+                    if ((*c < last_task) and (--num_pending_parents[*c - this->first_task] == 0)) {
+                        push_ready_task(*c - this->first_task);
+                    }
+                }
+            }
+
+            // Start ready tasks on idle hosts
+            while ((num_idle_hosts > 0) and (not ready_tasks.empty())) {
+                unsigned long priority = ready_tasks.front().first;
+                unsigned long task = ready_tasks.front().second;
+                std::pop_heap(ready_tasks.begin(), ready_tasks.end(), ready_cmp);
+                ready_tasks.pop_back();
+
+                double task_end_time = current_time + this->dag->getFlops(this->first_task + task) / this->core_speed;
+                makespan = std::max<double>(makespan, task_end_time);
+                this->start_dates[task] = current_time;
+                this->end_dates[task] = task_end_time;
+                this->started_tasks.push_back(task);
+                this->prefix_makespans.push_back(makespan);
+                num_scheduled_tasks++;
+
+                if (task_end_time > current_time) {
+                    this->tasks_by_end_date.insert(std::make_pair(task_end_time, task));
+                    running_tasks.push_back(std::make_pair(task_end_time, task));
+                    std::push_heap(running_tasks.begin(), running_tasks.end(), running_cmp);
+                    num_idle_hosts--;
+                    continue;
+                }
+
+                // A zero-duration task completes right away and does not hold its host
+                for (auto c = this->dag->getChildrenBegin(this->first_task + task);
+                     c != this->dag->getChildrenEnd(this->first_task + task); c++) {
+                    if ((*c < last_task) and (--num_pending_parents[*c - this->first_task] == 0)) {
+                        if (this->dag->getPriority(*c) > priority) {
+                            push_ready_task(*c - this->first_task);
+                        } else {
+                            deferred_tasks.push_back(*c - this->first_task);
+                        }
+                    }
+                }
+            }
+
+            if (num_scheduled_tasks == num_tasks) {
+                break;
+            }
+
+            if (not deferred_tasks.empty()) {
+                for (auto task : deferred_tasks) {
+                    push_ready_task(task);
+                }
+                deferred_tasks.clear();
+                continue;
+            }
+
+            if (running_tasks.empty()) {
+                throw std::runtime_error("LevelRangeSchedule::run(): Cannot schedule tasks with cyclic dependencies!");
+            }
+
+            // Move to the next completion date
+            current_time = running_tasks.front().first;
+        }
+    }
+
+};
@@ -0,0 +1,84 @@
+/**
+ * Copyright (c) 2017. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+
+#ifndef TASK_CLUSTERING_BATCH_SIMULATOR_LEVELRANGESCHEDULE_H
+#define TASK_CLUSTERING_BATCH_SIMULATOR_LEVELRANGESCHEDULE_H
+
+
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace wrench {
+
+    class DagSnapshot;
+
+    /**
+     * @brief The list schedule of the tasks in a range of workflow levels (the one whose makespan
+     *        WorkflowUtil::estimateMakespan() computes), which can be extended to more levels
+     *
+     * The tasks of an added level cannot become ready before the earliest date at which all the
+     * (in-range) parents of one of them complete. Until that date, the schedule is unchanged, so
+     * an extension only re-simulates the schedule from that date on, which typically costs about
+     * as much as scheduling the added level.
+     */
+    class LevelRangeSchedule {
+
+    public:
+
+        LevelRangeSchedule(std::shared_ptr<DagSnapshot> dag, unsigned long start_level, unsigned long end_level,
+                           unsigned long num_hosts, double core_speed);
+
+        void extendTo(unsigned long end_level);
+
+        unsigned long getEndLevel() const;
+
+        unsigned long getNumHosts() const;
+
+        double getMakespan() const;
+
+    private:
+
+        void run(double resume_date, unsigned long num_previous_tasks);
+
+        std::shared_ptr<DagSnapshot> dag;
+        unsigned long start_level;
+        unsigned long end_level;
+        unsigned long num_hosts;
+        double core_speed;
+
+        // Index of the first task of the range in the DAG snapshot (tasks below are numbered from it)
+        unsigned long first_task;
+
+        // Start and end dates of each task (-1 if not started)
+        std::vector<double> start_dates;
+        std::vector<double> end_dates;
+
+        // Tasks in the order in which they are started, and the makespan of each prefix of that order
+        std::vector<unsigned long> started_tasks;
+        std::vector<double> prefix_makespans;
+
+        // (end date, task) for each started task of non-zero duration
+        std::set<std::pair<double, unsigned long>> tasks_by_end_date;
+
+        // Scratch space of the simulation
+        std::vector<unsigned long> unstarted_tasks;
+        std::vector<unsigned long> num_pending_parents;
+        std::vector<std::pair<unsigned long, unsigned long>> ready_tasks;
+        std::vector<std::pair<double, unsigned long>> running_tasks;
+        std::vector<unsigned long> deferred_tasks;
+
+    };
+
+};
+
+
+#endif //TASK_CLUSTERING_BATCH_SIMULATOR_LEVELRANGESCHEDULE_H
@@ -3,6 +3,7 @@
 //
 
 #include <Util/PlaceHolderJob.h>
+#include <StaticClusteringAlgorithms/ClusteredJob.h>
 #include <workflow/job/PilotJob.h>
 #include <map>
 #include <string>
@@ -45,6 +46,98 @@ namespace wrench {
         // Duration stored in minutes, convert back to seconds
         return (duration - 1) * 60;
     }
+
+    /**
+     * @brief Count, for each task (those of the clustered job, if any), the parents whose completion
+     *        hasn't been processed yet, and queue the tasks that have none
+     * @param workflow: the workflow
+     * @param completed_tasks: the tasks whose completion has been processed
+     */
+    void PlaceHolderJob::initializeReadyQueue(Workflow *workflow,
+                                              const std::unordered_set<WorkflowTask *> &completed_tasks) {
+        this->num_unmet_parents.clear();
+        this->ready_tasks.clear();
+        std::vector<WorkflowTask *> tasks =
+                (this->clustered_job != nullptr) ? this->clustered_job->getTasks() : this->tasks;
+        for (auto task : tasks) {
+            if (completed_tasks.find(task) != completed_tasks.end()) {
+                continue;
+            }
+            unsigned long num_unmet_parents = 0;
+            for (auto parent : workflow->getTaskParents(task)) {
+                if (completed_tasks.find(parent) == completed_tasks.end()) {
+                    num_unmet_parents++;
+                }
+            }
+            if (num_unmet_parents == 0) {
+                this->ready_tasks.insert(task);
+            } else {
+                this->num_unmet_parents[task] = num_unmet_parents;
+            }
+        }
+    }
+
+    /**
+     * @brief Record that a parent of one of this placeholder job's tasks has completed, and
+     *        queue the task if it was the last one it was waiting for
+     * @param task: the task
+     */
+    void PlaceHolderJob::notifyParentCompletion(WorkflowTask *task) {
+        auto it = this->num_unmet_parents.find(task);
+        if (it == this->num_unmet_parents.end()) {
+            return;
+        }
+        if (--(it->second) == 0) {
+            this->num_unmet_parents.erase(it);
+            this->ready_tasks.insert(task);
+        }
+    }
+
+    /**
+     * @brief Remove the first queued task in a given level from the ready queue
+     * @param level: the level
+     * @return a task, or nullptr if no task in that level is queued
+     */
+    WorkflowTask *PlaceHolderJob::popReadyTask(unsigned long level) {
+        auto it = this->ready_tasks.lower_bound(level);
+        if ((it == this->ready_tasks.end()) or ((*it)->getTopLevel() != level)) {
+            return nullptr;
+        }
+        WorkflowTask *task = *it;
+        this->ready_tasks.erase(it);
+        return task;
+    }
+
+    /**
+     * @brief Remove the first queued task from the ready queue
+     * @return a task, or nullptr if no task is queued
+     */
+    WorkflowTask *PlaceHolderJob::popReadyTask() {
+        if (this->ready_tasks.empty()) {
+            return nullptr;
+        }
+        WorkflowTask *task = *(this->ready_tasks.begin());
+        this->ready_tasks.erase(this->ready_tasks.begin());
+        return task;
+    }
+
+    bool PlaceHolderJob::ReadyTaskOrder::operator()(const WorkflowTask *t1, const WorkflowTask *t2) const {
+        if (t1->getTopLevel() != t2->getTopLevel()) {
+            return (t1->getTopLevel() < t2->getTopLevel());
+        }
+        if (t1->getFlops() != t2->getFlops()) {
+            return (t1->getFlops() > t2->getFlops());
+        }
+        return (t1->getID() > t2->getID());
+    }
+
+    bool PlaceHolderJob::ReadyTaskOrder::operator()(const WorkflowTask *task, unsigned long level) const {
+        return (task->getTopLevel() < level);
+    }
+
+    bool PlaceHolderJob::ReadyTaskOrder::operator()(unsigned long level, const WorkflowTask *task) const {
+        return (level < task->getTopLevel());
+    }
 }
 
 
@@ -4,6 +4,9 @@
 #define YOUR_PROJECT_NAME_PLACEHOLDERJOB_H
 
 #include <vector>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
 #include <wrench-dev.h>
 
 namespace wrench {
@@ -14,6 +17,8 @@ namespace wrench {
 
     class ClusteredJob;
 
+    class Workflow;
+
     class PlaceHolderJob {
 
     public:
@@ -40,8 +45,29 @@ namespace wrench {
 
         double getDuration();
 
+        void initializeReadyQueue(Workflow *workflow, const std::unordered_set<WorkflowTask *> &completed_tasks);
+
+        void notifyParentCompletion(WorkflowTask *task);
+
+        WorkflowTask *popReadyTask(unsigned long level);
+
+        WorkflowTask *popReadyTask();
+
         // For lbl
-        ClusteredJob *clustered_job;
+        ClusteredJob *clustered_job = nullptr;
+
+    private:
+
+        // Ready tasks are started by level, then by decreasing flops (ties broken by decreasing ID)
+        struct ReadyTaskOrder {
+            using is_transparent = void;
+            bool operator()(const WorkflowTask *t1, const WorkflowTask *t2) const;
+            bool operator()(const WorkflowTask *task, unsigned long level) const;
+            bool operator()(unsigned long level, const WorkflowTask *task) const;
+        };
+
+        std::unordered_map<WorkflowTask *, unsigned long> num_unmet_parents;
+        std::set<WorkflowTask *, ReadyTaskOrder> ready_tasks;
     };
 
 };
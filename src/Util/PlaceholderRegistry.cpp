@@ -0,0 +1,132 @@
+/**
+ * Copyright (c) 2017. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+
+#include <wrench-dev.h>
+
+#include "PlaceholderRegistry.h"
+#include "PlaceHolderJob.h"
+#include <StaticClusteringAlgorithms/ClusteredJob.h>
+
+
+namespace wrench {
+
+    /**
+     * @brief Start tracking a placeholder job, whose pilot job must already have been created
+     * @param placeholder_job: the placeholder job
+     * @param ongoing_level: the ongoing level the placeholder job is part of (nullptr if none)
+     *
+     * @throw std::invalid_argument
+     */
+    void PlaceholderRegistry::add(PlaceHolderJob *placeholder_job, OngoingLevel *ongoing_level) {
+        if ((placeholder_job == nullptr) or (placeholder_job->pilot_job == nullptr)) {
+            throw std::invalid_argument("PlaceholderRegistry::add(): invalid arguments");
+        }
+        for (auto task : getTasks(placeholder_job)) {
+            this->task_to_placeholder_job[task] = placeholder_job;
+        }
+        this->pilot_job_to_placeholder_job[placeholder_job->pilot_job.get()] = placeholder_job;
+        this->placeholder_job_to_ongoing_level[placeholder_job] = ongoing_level;
+    }
+
+    /**
+     * @brief Stop tracking a placeholder job (does nothing if it isn't tracked)
+     * @param placeholder_job: the placeholder job
+     */
+    void PlaceholderRegistry::remove(PlaceHolderJob *placeholder_job) {
+        if (this->placeholder_job_to_ongoing_level.erase(placeholder_job) == 0) {
+            return;
+        }
+        for (auto task : getTasks(placeholder_job)) {
+            auto it = this->task_to_placeholder_job.find(task);
+            if ((it != this->task_to_placeholder_job.end()) and (it->second == placeholder_job)) {
+                this->task_to_placeholder_job.erase(it);
+            }
+        }
+        this->pilot_job_to_placeholder_job.erase(placeholder_job->pilot_job.get());
+    }
+
+    /**
+     * @brief Check whether a placeholder job is tracked
+     * @param placeholder_job: the placeholder job
+     * @return true or false
+     */
+    bool PlaceholderRegistry::contains(PlaceHolderJob *placeholder_job) const {
+        return this->placeholder_job_to_ongoing_level.find(placeholder_job) !=
+               this->placeholder_job_to_ongoing_level.end();
+    }
+
+    /**
+     * @brief Find the tracked placeholder job that a task belongs to
+     * @param task: the task
+     * @return a placeholder job, or nullptr if none
+     */
+    PlaceHolderJob *PlaceholderRegistry::getPlaceholderJob(WorkflowTask *task) const {
+        auto it = this->task_to_placeholder_job.find(task);
+        return (it == this->task_to_placeholder_job.end()) ? nullptr : it->second;
+    }
+
+    /**
+     * @brief Find the tracked placeholder job that runs as a pilot job
+     * @param pilot_job: the pilot job
+     * @return a placeholder job, or nullptr if none
+     */
+    PlaceHolderJob *PlaceholderRegistry::getPlaceholderJob(PilotJob *pilot_job) const {
+        auto it = this->pilot_job_to_placeholder_job.find(pilot_job);
+        return (it == this->pilot_job_to_placeholder_job.end()) ? nullptr : it->second;
+    }
+
+    /**
+     * @brief Find the ongoing level that a tracked placeholder job is part of
+     * @param placeholder_job: the placeholder job
+     * @return an ongoing level, or nullptr if none
+     */
+    OngoingLevel *PlaceholderRegistry::getOngoingLevel(PlaceHolderJob *placeholder_job) const {
+        auto it = this->placeholder_job_to_ongoing_level.find(placeholder_job);
+        return (it == this->placeholder_job_to_ongoing_level.end()) ? nullptr : it->second;
+    }
+
+    /**
+     * @brief Get the tasks of a placeholder job, whether it holds them itself or through
+     *        a clustered job (level-by-level)
+     * @param placeholder_job: the placeholder job
+     * @return a list of tasks
+     */
+    std::vector<WorkflowTask *> PlaceholderRegistry::getTasks(PlaceHolderJob *placeholder_job) {
+        if (placeholder_job->clustered_job != nullptr) {
+            return placeholder_job->clustered_job->getTasks();
+        }
+        return placeholder_job->tasks;
+    }
+
+    /**
+     * @brief Record that the WMS has processed a task's completion, and notify the tracked placeholder
+     *        jobs that hold its children
+     * @param task: the completed task
+     * @param workflow: the workflow
+     */
+    void PlaceholderRegistry::notifyTaskCompletion(WorkflowTask *task, Workflow *workflow) {
+        this->completed_tasks.insert(task);
+        for (auto child : workflow->getTaskChildren(task)) {
+            PlaceHolderJob *placeholder_job = this->getPlaceholderJob(child);
+            if (placeholder_job != nullptr) {
+                placeholder_job->notifyParentCompletion(child);
+            }
+        }
+    }
+
+    /**
+     * @brief Get the tasks whose completion the WMS has processed
+     * @return a set of tasks
+     */
+    const std::unordered_set<WorkflowTask *> &PlaceholderRegistry::getCompletedTasks() const {
+        return this->completed_tasks;
+    }
+
+};
@@ -0,0 +1,72 @@
+/**
+ * Copyright (c) 2017. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+
+#ifndef TASK_CLUSTERING_BATCH_SIMULATOR_PLACEHOLDERREGISTRY_H
+#define TASK_CLUSTERING_BATCH_SIMULATOR_PLACEHOLDERREGISTRY_H
+
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace wrench {
+
+    class Workflow;
+    class WorkflowTask;
+    class PilotJob;
+    class PlaceHolderJob;
+    class OngoingLevel;
+
+    /**
+     * @brief An index of the placeholder jobs a WMS is currently tracking, which finds the placeholder
+     *        job (and, for level-by-level WMSs, the ongoing level) that a task or a pilot job belongs to
+     *        without scanning every placeholder job
+     *
+     * A task belongs to the placeholder job that was added last with it, so that a task handed to a
+     * replacement placeholder job is not lost when the replaced one is removed. The registry also
+     * records which task completions the WMS has processed, and forwards each completion to the
+     * ready queues of the tracked placeholder jobs that hold the task's children.
+     */
+    class PlaceholderRegistry {
+
+    public:
+
+        void add(PlaceHolderJob *placeholder_job, OngoingLevel *ongoing_level = nullptr);
+
+        void remove(PlaceHolderJob *placeholder_job);
+
+        bool contains(PlaceHolderJob *placeholder_job) const;
+
+        PlaceHolderJob *getPlaceholderJob(WorkflowTask *task) const;
+
+        PlaceHolderJob *getPlaceholderJob(PilotJob *pilot_job) const;
+
+        OngoingLevel *getOngoingLevel(PlaceHolderJob *placeholder_job) const;
+
+        static std::vector<WorkflowTask *> getTasks(PlaceHolderJob *placeholder_job);
+
+        void notifyTaskCompletion(WorkflowTask *task, Workflow *workflow);
+
+        const std::unordered_set<WorkflowTask *> &getCompletedTasks() const;
+
+    private:
+
+        std::unordered_set<WorkflowTask *> completed_tasks;
+
+        std::unordered_map<WorkflowTask *, PlaceHolderJob *> task_to_placeholder_job;
+        std::unordered_map<PilotJob *, PlaceHolderJob *> pilot_job_to_placeholder_job;
+        std::unordered_map<PlaceHolderJob *, OngoingLevel *> placeholder_job_to_ongoing_level;
+
+    };
+
+};
+
+
+#endif //TASK_CLUSTERING_BATCH_SIMULATOR_PLACEHOLDERREGISTRY_H
@@ -0,0 +1,250 @@
+/**
+ * Copyright (c) 2017. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+
+#include <wrench-dev.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include "ProfilePredictor.h"
+
+
+namespace wrench {
+
+    /**
+     * @brief Constructor
+     * @param trace_file: the background workload trace file (SWF)
+     * @param num_nodes: the number of compute nodes
+     * @param use_real_runtimes_as_requested_runtimes: whether trace jobs request their actual execution times
+     *
+     * @throw std::invalid_argument
+     */
+    ProfilePredictor::ProfilePredictor(std::string trace_file, unsigned long num_nodes,
+                                       bool use_real_runtimes_as_requested_runtimes) {
+        if (num_nodes == 0) {
+            throw std::invalid_argument("ProfilePredictor::ProfilePredictor(): invalid number of nodes");
+        }
+        this->num_nodes = num_nodes;
+        this->free_nodes[0] = num_nodes;
+        this->loadSWFTraceFile(trace_file, use_real_runtimes_as_requested_runtimes);
+    }
+
+    /**
+     * @brief Load the jobs of a SWF trace file the way the batch service does: invalid jobs (and jobs
+     *        that ask for more nodes than there are) are ignored, and submit dates are shifted so that
+     *        the first job is submitted at date 0
+     * @param trace_file: the trace file
+     * @param use_real_runtimes_as_requested_runtimes: whether jobs request their actual execution times
+     *
+     * @throw std::invalid_argument
+     */
+    void ProfilePredictor::loadSWFTraceFile(std::string trace_file, bool use_real_runtimes_as_requested_runtimes) {
+        if ((trace_file.size() < 4) or (trace_file.substr(trace_file.size() - 4) != ".swf")) {
+            throw std::invalid_argument("ProfilePredictor::loadSWFTraceFile(): only SWF trace files are supported");
+        }
+        std::ifstream file(trace_file);
+        if (not file) {
+            throw std::invalid_argument("ProfilePredictor::loadSWFTraceFile(): cannot open trace file " + trace_file);
+        }
+
+        std::string line;
+        while (std::getline(file, line)) {
+            if (line.empty() or (line[0] == ';')) {
+                continue;
+            }
+            std::istringstream ss(line);
+            std::vector<double> fields;
+            double field;
+            while (ss >> field) {
+                fields.push_back(field);
+            }
+            if (fields.size() < 9) {
+                continue;
+            }
+
+            // SWF fields: 1 = submit time, 3 = run time, 4 = allocated processors,
+            // 7 = requested processors, 8 = requested time
+            TraceJob job;
+            job.submit_date = fields[1];
+            job.execution_time = fields[3];
+            double num_nodes = (fields[7] > 0) ? fields[7] : fields[4];
+            job.requested_execution_time = (fields[8] > 0) ? fields[8] : fields[3];
+            if (use_real_runtimes_as_requested_runtimes) {
+                job.requested_execution_time = job.execution_time;
+            }
+            if ((job.submit_date < 0) or (job.execution_time <= 0) or (job.requested_execution_time <= 0) or
+                (num_nodes < 1) or (num_nodes > this->num_nodes)) {
+                continue;
+            }
+            job.num_nodes = (unsigned long) num_nodes;
+            // Jobs are killed when they reach their requested execution times
+            job.execution_time = std::min<double>(job.execution_time, job.requested_execution_time);
+            this->trace_jobs.push_back(job);
+        }
+
+        std::stable_sort(this->trace_jobs.begin(), this->trace_jobs.end(),
+                         [](const TraceJob &a, const TraceJob &b) { return a.submit_date < b.submit_date; });
+        if (not this->trace_jobs.empty()) {
+            double first_submit_date = this->trace_jobs.front().submit_date;
+            for (auto &job : this->trace_jobs) {
+                job.submit_date -= first_submit_date;
+            }
+        }
+    }
+
+    /**
+     * @brief Estimate the start dates of job configurations submitted at the current simulation date
+     * @param job_configurations: (unique key, number of nodes, number of cores per node, requested execution time) tuples
+     * @return start date estimates, by key
+     *
+     * @throw std::invalid_argument
+     */
+    std::map<std::string, double> ProfilePredictor::getStartTimeEstimates(
+            std::set<std::tuple<std::string, unsigned long, unsigned long, double>> job_configurations) {
+        double date = Simulation::getCurrentSimulatedDate();
+        this->advanceTo(date);
+
+        std::map<std::string, double> estimates;
+        for (auto const &job_configuration : job_configurations) {
+            unsigned long num_nodes = std::get<1>(job_configuration);
+            if ((num_nodes == 0) or (num_nodes > this->num_nodes)) {
+                throw std::invalid_argument("ProfilePredictor::getStartTimeEstimates(): invalid number of nodes");
+            }
+            estimates[std::get<0>(job_configuration)] =
+                    this->findEarliestStartDate(date, num_nodes, std::get<3>(job_configuration));
+        }
+        return estimates;
+    }
+
+    /**
+     * @brief Add a job, submitted at the current simulation date, to the profile
+     * @param job: the job
+     * @param num_nodes: the job's number of nodes
+     * @param requested_execution_time: the job's requested execution time
+     */
+    void ProfilePredictor::notifyJobSubmission(WorkflowJob *job, unsigned long num_nodes,
+                                               double requested_execution_time) {
+        double date = Simulation::getCurrentSimulatedDate();
+        this->advanceTo(date);
+        num_nodes = std::min<unsigned long>(num_nodes, this->num_nodes);
+        double start_date = this->findEarliestStartDate(date, num_nodes, requested_execution_time);
+        this->reserve(start_date, num_nodes, requested_execution_time);
+        this->workflow_job_reservations[job->getName()] = {start_date, start_date + requested_execution_time,
+                                                          num_nodes};
+    }
+
+    /**
+     * @brief Release the rest of the reservation of a job that left the batch service at the current simulation date
+     * @param job: the job (ignored if it was not added to the profile)
+     */
+    void ProfilePredictor::notifyJobTermination(WorkflowJob *job) {
+        auto it = this->workflow_job_reservations.find(job->getName());
+        if (it == this->workflow_job_reservations.end()) {
+            return;
+        }
+        Reservation reservation = it->second;
+        this->workflow_job_reservations.erase(it);
+
+        double date = Simulation::getCurrentSimulatedDate();
+        this->advanceTo(date);
+        this->updateFreeNodes(std::max<double>(reservation.start_date, date), reservation.end_date,
+                              (long) reservation.num_nodes);
+    }
+
+    /**
+     * @brief Add the trace jobs submitted up to a date to the profile, and drop the profile before that date
+     * @param date: a date (no earlier than that of the previous call)
+     */
+    void ProfilePredictor::advanceTo(double date) {
+        while ((this->next_trace_job < this->trace_jobs.size()) and
+               (this->trace_jobs[this->next_trace_job].submit_date <= date)) {
+            auto const &job = this->trace_jobs[this->next_trace_job++];
+            this->discardBefore(job.submit_date);
+            this->reserve(this->findEarliestStartDate(job.submit_date, job.num_nodes, job.requested_execution_time),
+                          job.num_nodes, job.execution_time);
+        }
+        this->discardBefore(date);
+    }
+
+    /**
+     * @brief Drop the part of the profile that is before a date
+     * @param date: a date
+     */
+    void ProfilePredictor::discardBefore(double date) {
+        auto it = this->free_nodes.upper_bound(date);
+        if (it == this->free_nodes.begin()) {
+            return;
+        }
+        unsigned long free_nodes_at_date = std::prev(it)->second;
+        this->free_nodes.erase(this->free_nodes.begin(), it);
+        this->free_nodes[date] = free_nodes_at_date;
+    }
+
+    /**
+     * @brief Find the earliest date, at or after a date, from which enough nodes are free for a duration
+     * @param date: a date (no earlier than the beginning of the profile)
+     * @param num_nodes: a number of nodes (at most the number of compute nodes)
+     * @param duration: a duration
+     * @return a date
+     */
+    double ProfilePredictor::findEarliestStartDate(double date, unsigned long num_nodes, double duration) const {
+        auto step = std::prev(this->free_nodes.upper_bound(date));
+        double start_date = date;
+        while (true) {
+            bool fits = true;
+            auto it = step;
+            do {
+                if (it->second < num_nodes) {
+                    fits = false;
+                    break;
+                }
+                it++;
+            } while ((it != this->free_nodes.end()) and (it->first < start_date + duration));
+            if (fits) {
+                return start_date;
+            }
+            // Try from the end of the step that has too few free nodes (the last step has them all)
+            step = std::next(it);
+            start_date = step->first;
+        }
+    }
+
+    /**
+     * @brief Reserve nodes in the profile
+     * @param start_date: the reservation's start date
+     * @param num_nodes: the reservation's number of nodes (free during the whole reservation)
+     * @param duration: the reservation's duration
+     */
+    void ProfilePredictor::reserve(double start_date, unsigned long num_nodes, double duration) {
+        this->updateFreeNodes(start_date, start_date + duration, -((long) num_nodes));
+    }
+
+    /**
+     * @brief Change the number of free nodes in the profile during a time interval
+     * @param start_date: the interval's start date (no earlier than the beginning of the profile)
+     * @param end_date: the interval's end date
+     * @param delta: the change in the number of free nodes
+     */
+    void ProfilePredictor::updateFreeNodes(double start_date, double end_date, long delta) {
+        if (end_date <= start_date) {
+            return;
+        }
+        for (double date : {start_date, end_date}) {
+            auto it = this->free_nodes.upper_bound(date);
+            if (std::prev(it)->first != date) {
+                this->free_nodes.insert(it, std::make_pair(date, std::prev(it)->second));
+            }
+        }
+        for (auto it = this->free_nodes.find(start_date); it->first < end_date; it++) {
+            it->second += delta;
+        }
+    }
+
+};
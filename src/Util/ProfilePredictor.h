@@ -0,0 +1,90 @@
+/**
+ * Copyright (c) 2017. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+
+#ifndef TASK_CLUSTERING_BATCH_SIMULATOR_PROFILEPREDICTOR_H
+#define TASK_CLUSTERING_BATCH_SIMULATOR_PROFILEPREDICTOR_H
+
+
+#include <string>
+#include <vector>
+#include "WaitTimePredictor.h"
+
+namespace wrench {
+
+    /**
+     * @brief A wait time predictor that answers in-process, from its own node availability profile
+     *
+     * The profile is a conservative backfilling reservation list. The jobs of the background
+     * workload trace (SWF) are added to it as the simulation date reaches their submit dates: each
+     * one is given the earliest slot, at or after its submit date, in which it fits for its
+     * requested execution time, and holds its nodes for its actual execution time (as if the list
+     * had been compressed when it completed). The workflow's jobs are added when notified, and hold
+     * their nodes for their requested execution times, or until they are notified to have left the
+     * batch service (the other reservations are not moved up then). A configuration's start date
+     * estimate is its earliest slot in the current profile.
+     */
+    class ProfilePredictor : public WaitTimePredictor {
+
+    public:
+
+        ProfilePredictor(std::string trace_file, unsigned long num_nodes, bool use_real_runtimes_as_requested_runtimes);
+
+        std::map<std::string, double>
+        getStartTimeEstimates(std::set<std::tuple<std::string, unsigned long, unsigned long, double>> job_configurations) override;
+
+        void notifyJobSubmission(WorkflowJob *job, unsigned long num_nodes, double requested_execution_time) override;
+
+        void notifyJobTermination(WorkflowJob *job) override;
+
+    private:
+
+        struct TraceJob {
+            double submit_date;
+            double requested_execution_time;
+            double execution_time;
+            unsigned long num_nodes;
+        };
+
+        struct Reservation {
+            double start_date;
+            double end_date;
+            unsigned long num_nodes;
+        };
+
+        void loadSWFTraceFile(std::string trace_file, bool use_real_runtimes_as_requested_runtimes);
+
+        void advanceTo(double date);
+
+        void discardBefore(double date);
+
+        double findEarliestStartDate(double date, unsigned long num_nodes, double duration) const;
+
+        void reserve(double start_date, unsigned long num_nodes, double duration);
+
+        void updateFreeNodes(double start_date, double end_date, long delta);
+
+        unsigned long num_nodes;
+
+        // Trace jobs, by submit date, and the first one that is not in the profile yet
+        std::vector<TraceJob> trace_jobs;
+        unsigned long next_trace_job = 0;
+
+        // Number of free nodes from each date until the next one (the last entry lasts forever)
+        std::map<double, unsigned long> free_nodes;
+
+        // Reservations of the workflow's jobs that have not left the batch service, by job name
+        std::map<std::string, Reservation> workflow_job_reservations;
+
+    };
+
+};
+
+
+#endif //TASK_CLUSTERING_BATCH_SIMULATOR_PROFILEPREDICTOR_H
@@ -7,17 +7,28 @@
 #include <services/compute/batch/BatchComputeService.h>
 #include "ProxyWMS.h"
 #include "PlaceHolderJob.h"
+#include "WorkflowUtil.h"
+#include "DagSnapshot.h"
+#include "WaitTimeSurface.h"
+#include "WaitTimePredictor.h"
+#include "QueryProfiler.h"
 
 XBT_LOG_NEW_DEFAULT_CATEGORY(proxy_wms, "Log category for Proxy WMS");
 
 
 namespace wrench {
 
+    unsigned long ProxyWMS::num_start_time_estimate_hits = 0;
+    unsigned long ProxyWMS::num_start_time_estimate_misses = 0;
+    unsigned long ProxyWMS::num_start_time_estimate_interpolations = 0;
+
     ProxyWMS::ProxyWMS(Workflow *workflow, std::shared_ptr<JobManager> job_manager,
-                       std::shared_ptr<BatchComputeService> batch_service) {
+                       std::shared_ptr<BatchComputeService> batch_service,
+                       std::shared_ptr<WaitTimePredictor> wait_time_predictor) {
         this->workflow = workflow;
         this->job_manager = job_manager;
         this->batch_service = batch_service;
+        this->wait_time_predictor = wait_time_predictor;
     }
 
     PlaceHolderJob *ProxyWMS::createAndSubmitPlaceholderJob(double requested_execution_time,
@@ -28,13 +39,12 @@ namespace wrench {
         requested_execution_time = requested_execution_time * EXECUTION_TIME_FUDGE_FACTOR;
 
         // Aggregate tasks
+        auto dag = WorkflowUtil::getDagSnapshot(this->workflow);
         std::vector<WorkflowTask *> tasks;
-        for (unsigned long l = start_level; l <= end_level; l++) {
-            std::vector<WorkflowTask *> tasks_in_level = this->workflow->getTasksInTopLevelRange(l, l);
-            for (auto t : tasks_in_level) {
-                if (t->getState() != WorkflowTask::COMPLETED) {
-                    tasks.push_back(t);
-                }
+        for (auto i : dag->getIndicesInTopLevelRange(start_level, end_level)) {
+            WorkflowTask *t = dag->getTask(i);
+            if (t->getState() != WorkflowTask::COMPLETED) {
+                tasks.push_back(t);
             }
         }
 
@@ -55,31 +65,110 @@ namespace wrench {
         }
 
         this->job_manager->submitJob(pj->pilot_job, this->batch_service, service_specific_args);
+        this->wait_time_predictor->notifyJobSubmission(pj->pilot_job.get(), requested_parallelism,
+                                                       60.0 * std::stoul(service_specific_args["-t"]));
+        this->clearStartTimeEstimates();
 
         return pj;
     }
 
+    /**
+     * @brief Submit READY tasks as individual one-node jobs, as long as fewer than max_num_jobs jobs are in
+     *        the system. READY tasks are taken from the ready frontier, which the first call seeds with all
+     *        the workflow's READY tasks, and which ProxyWMS::notifyTaskCompletion() then feeds.
+     * @param core_speed: the core speed
+     * @param num_jobs_in_system: the number of jobs in the system (incremented for each submitted job)
+     * @param max_num_jobs: the maximum number of jobs in the system
+     */
     void ProxyWMS::submitAllOneJobPerTask(double core_speed, unsigned long * num_jobs_in_system, unsigned long max_num_jobs) {
-        for (auto task : this->workflow->getTasks()) {
-            if (task->getState() == WorkflowTask::State::READY and (*num_jobs_in_system < max_num_jobs)) {
-                // std::cout << "Submitting as ojpt, num jobs in system before submission: " << (*num_jobs_in_system) << std::endl;
-                auto standard_job = this->job_manager->createStandardJob(task, {});
-                std::map<std::string, std::string> service_specific_args;
-                // TODO - this cast is horrible, but should be okay?
-                unsigned long requested_execution_time =
-                        (unsigned long) (task->getFlops() / core_speed) * EXECUTION_TIME_FUDGE_FACTOR;
-                service_specific_args["-N"] = "1";
-                service_specific_args["-c"] = "1";
-                service_specific_args["-t"] = std::to_string(1 + ((unsigned long) requested_execution_time) / 60);
-
-                WRENCH_INFO("Submitting task %s individually!", task->getID().c_str());
-                // std::cout << "Submitting task " << task->getID().c_str() << " individually!\n";
-                this->job_manager->submitJob(standard_job, this->batch_service, service_specific_args);
-                (*num_jobs_in_system)++;
+        if (not this->ready_frontier_seeded) {
+            for (auto task : this->workflow->getTasks()) {
+                if (task->getState() == WorkflowTask::State::READY) {
+                    this->ready_frontier.push_back(task);
+                }
+            }
+            this->ready_frontier_seeded = true;
+        }
+
+        bool submitted = false;
+        while ((not this->ready_frontier.empty()) and (*num_jobs_in_system < max_num_jobs)) {
+            WorkflowTask *task = this->ready_frontier.front();
+            this->ready_frontier.pop_front();
+            if (task->getState() != WorkflowTask::State::READY) {
+                // Already submitted (e.g., queued twice, or started in a placeholder job)
+                continue;
+            }
+            // std::cout << "Submitting as ojpt, num jobs in system before submission: " << (*num_jobs_in_system) << std::endl;
+            auto standard_job = this->job_manager->createStandardJob(task, {});
+            std::map<std::string, std::string> service_specific_args;
+            // TODO - this cast is horrible, but should be okay?
+            unsigned long requested_execution_time =
+                    (unsigned long) (task->getFlops() / core_speed) * EXECUTION_TIME_FUDGE_FACTOR;
+            service_specific_args["-N"] = "1";
+            service_specific_args["-c"] = "1";
+            service_specific_args["-t"] = std::to_string(1 + ((unsigned long) requested_execution_time) / 60);
+
+            WRENCH_INFO("Submitting task %s individually!", task->getID().c_str());
+            // std::cout << "Submitting task " << task->getID().c_str() << " individually!\n";
+            this->job_manager->submitJob(standard_job, this->batch_service, service_specific_args);
+            this->wait_time_predictor->notifyJobSubmission(standard_job.get(), 1,
+                                                           60.0 * std::stoul(service_specific_args["-t"]));
+            (*num_jobs_in_system)++;
+            submitted = true;
+        }
+
+        if (submitted) {
+            this->clearStartTimeEstimates();
+        }
+    }
+
+    /**
+     * @brief Terminate a job submitted to the batch service (pending or running), and release the rest of
+     *        its reservation in the wait time predictor
+     * @param job: the job
+     *
+     * @throw WorkflowExecutionException
+     */
+    void ProxyWMS::terminateJob(std::shared_ptr<WorkflowJob> job) {
+        // Released first, as the job may already have left the batch service
+        this->notifyJobTermination(job.get());
+        this->job_manager->terminateJob(job);
+    }
+
+    /**
+     * @brief Release the rest of the reservation, in the wait time predictor, of a job that left the batch
+     *        service (it completed, failed or expired)
+     * @param job: the job (that may not have been submitted to the batch service)
+     */
+    void ProxyWMS::notifyJobTermination(WorkflowJob *job) {
+        this->wait_time_predictor->notifyJobTermination(job);
+        this->clearStartTimeEstimates();
+    }
+
+    /**
+     * @brief Feed the ready frontier (once seeded) with the children of a completed task that are now READY
+     * @param task: the completed task
+     */
+    void ProxyWMS::notifyTaskCompletion(WorkflowTask *task) {
+        if (not this->ready_frontier_seeded) {
+            return;
+        }
+        for (auto child : this->workflow->getTaskChildren(task)) {
+            if (child->getState() == WorkflowTask::State::READY) {
+                this->ready_frontier.push_back(child);
             }
         }
     }
 
+    /**
+     * @brief Discard the ready frontier, so that the next individual submission rescans the workflow (for
+     *        when tasks become READY again because their job failed or expired)
+     */
+    void ProxyWMS::resetReadyFrontier() {
+        this->ready_frontier.clear();
+        this->ready_frontier_seeded = false;
+    }
+
     double ProxyWMS::findMaxDuration(std::set<wrench::PlaceHolderJob *> jobs) {
         double max_duration = 0;
         for (PlaceHolderJob *pj : jobs) {
@@ -90,28 +179,183 @@ namespace wrench {
     }
 
     double ProxyWMS::estimateWaitTime(long parallelism, double makespan, double simulation_date, int *sequence) {
-        std::set<std::tuple<std::string, unsigned long, unsigned long, double>> job_config;
-        std::string config_key = "config_XXXX_" + std::to_string((*sequence)++); // need to make it unique for BATSCHED
-        job_config.insert(std::make_tuple(config_key, (unsigned int) parallelism, 1, makespan));
-        std::map<std::string, double> estimates = this->batch_service->getStartTimeEstimates(job_config);
+        return this->estimateWaitTimes({std::make_pair((unsigned int) parallelism, makespan)},
+                                       simulation_date, sequence)[0];
+    }
+
+    /**
+     * @brief Estimate the wait times of several job configurations with at most one request to the batch service.
+     *        Requested execution times are rounded up to the minute, as they are when jobs are submitted,
+     *        and start time estimates are cached until the simulation date advances or
+     *        ProxyWMS::clearStartTimeEstimates() is called. Configurations that are neither cached nor
+     *        in a cached bucket are answered by the wait time surface, if one was built and covers them.
+     * @param configurations: (number of nodes, requested execution time) pairs
+     * @param simulation_date: the current simulation date
+     * @param sequence: the counter used to make configuration keys unique
+     * @return the wait time estimates, in the order of the configurations
+     *
+     * @throw std::runtime_error
+     */
+    std::vector<double> ProxyWMS::estimateWaitTimes(const std::vector<std::pair<unsigned long, double>> &configurations,
+                                                    double simulation_date, int *sequence) {
+        QueryProfiler::Query query(QueryProfiler::HEURISTIC_QUERY, configurations.size());
+
+        if (simulation_date != this->start_time_estimates_date) {
+            this->clearStartTimeEstimates();
+            this->start_time_estimates_date = simulation_date;
+        }
+
+        // Request the configurations that are neither in the cache nor covered by the surface
+        std::vector<std::pair<unsigned long, unsigned long>> buckets;
+        std::set<std::pair<unsigned long, unsigned long>> missing_buckets;
+        for (auto const &configuration : configurations) {
+            auto bucket = std::make_pair(configuration.first, 1 + ((unsigned long) configuration.second) / 60);
+            buckets.push_back(bucket);
+            if ((this->start_time_estimates.find(bucket) != this->start_time_estimates.end()) or
+                (missing_buckets.find(bucket) != missing_buckets.end())) {
+                num_start_time_estimate_hits++;
+            } else if (this->wait_time_surface and this->wait_time_surface->covers(bucket.first, bucket.second)) {
+                num_start_time_estimate_interpolations++;
+            } else {
+                num_start_time_estimate_misses++;
+                missing_buckets.insert(bucket);
+            }
+        }
+        this->requestStartTimeEstimates(missing_buckets, sequence);
+
+        std::vector<double> wait_time_estimates;
+        for (auto const &bucket : buckets) {
+            auto estimate = this->start_time_estimates.find(bucket);
+            double start_time_estimate = (estimate != this->start_time_estimates.end()) ?
+                                         estimate->second :
+                                         this->wait_time_surface->getStartTime(bucket.first, bucket.second);
+            wait_time_estimates.push_back(std::max<double>(0, start_time_estimate - simulation_date));
+        }
+
+        return wait_time_estimates;
+    }
+
+    /**
+     * @brief Build a wait time surface, with a single request to the batch service, that answers all later
+     *        wait time estimates (until the simulation date advances or ProxyWMS::clearStartTimeEstimates() is
+     *        called) for up to max_num_nodes nodes and up to max_execution_time. The surface's numbers of nodes
+     *        are the powers of two and the widths of the levels in a range, and its requested minutes are log-spaced.
+     * @param start_level: the first level
+     * @param end_level: the last level
+     * @param max_num_nodes: the largest number of nodes
+     * @param max_execution_time: the largest requested execution time
+     * @param simulation_date: the current simulation date
+     * @param sequence: the counter used to make configuration keys unique
+     */
+    void ProxyWMS::buildWaitTimeSurface(unsigned long start_level, unsigned long end_level,
+                                        unsigned long max_num_nodes, double max_execution_time,
+                                        double simulation_date, int *sequence) {
+        if (simulation_date != this->start_time_estimates_date) {
+            this->clearStartTimeEstimates();
+            this->start_time_estimates_date = simulation_date;
+        }
+
+        std::set<unsigned long> node_counts;
+        for (unsigned long n = 1; n < max_num_nodes; n *= 2) {
+            node_counts.insert(n);
+        }
+        node_counts.insert(max_num_nodes);
+        auto dag = WorkflowUtil::getDagSnapshot(this->workflow);
+        for (unsigned long l = start_level; (l <= end_level) and (l < dag->getNumLevels()); l++) {
+            node_counts.insert(std::max<unsigned long>(1, std::min<unsigned long>(max_num_nodes,
+                                                                                  dag->getNumTasksInLevel(l))));
+        }
+        std::vector<unsigned long> minutes = WaitTimeSurface::getLogSpacedMinutes(
+                1 + ((unsigned long) max_execution_time) / 60);
+
+        std::set<std::pair<unsigned long, unsigned long>> missing_buckets;
+        for (auto n : node_counts) {
+            for (auto m : minutes) {
+                if (this->start_time_estimates.find(std::make_pair(n, m)) == this->start_time_estimates.end()) {
+                    missing_buckets.insert(std::make_pair(n, m));
+                }
+            }
+        }
+        this->requestStartTimeEstimates(missing_buckets, sequence);
+
+        std::vector<double> start_times;
+        for (auto n : node_counts) {
+            for (auto m : minutes) {
+                start_times.push_back(this->start_time_estimates[std::make_pair(n, m)]);
+            }
+        }
+        this->wait_time_surface = std::make_shared<WaitTimeSurface>(
+                std::vector<unsigned long>(node_counts.begin(), node_counts.end()), minutes, start_times);
+    }
+
+    /**
+     * @brief Get start time estimates from the wait time predictor, with a single request, and cache them
+     * @param buckets: (number of nodes, requested minutes) pairs
+     * @param sequence: the counter used to make configuration keys unique
+     *
+     * @throw std::runtime_error
+     */
+    void ProxyWMS::requestStartTimeEstimates(const std::set<std::pair<unsigned long, unsigned long>> &buckets,
+                                             int *sequence) {
+        if (buckets.empty()) {
+            return;
+        }
+
+        std::set<std::tuple<std::string, unsigned long, unsigned long, double>> job_configs;
+        std::map<std::string, std::pair<unsigned long, unsigned long>> config_buckets;
+        for (auto const &bucket : buckets) {
+            std::string config_key = "config_XXXX_" + std::to_string((*sequence)++); // need to make it unique for BATSCHED
+            job_configs.insert(std::make_tuple(config_key, bucket.first, 1, 60.0 * bucket.second));
+            config_buckets[config_key] = bucket;
+        }
+        std::map<std::string, double> estimates;
+        {
+            QueryProfiler::Query request(QueryProfiler::SCHEDULER_REQUEST, job_configs.size());
+            estimates = this->wait_time_predictor->getStartTimeEstimates(job_configs);
+        }
 
-        if (estimates[config_key] < 0) {
-            throw std::runtime_error("Could not obtain start time estimate... aborting");
+        for (auto const &config_bucket : config_buckets) {
+            auto estimate = estimates.find(config_bucket.first);
+            if ((estimate == estimates.end()) or (estimate->second < 0)) {
+                throw std::runtime_error("Could not obtain start time estimate... aborting");
+            }
+            this->start_time_estimates[config_bucket.second] = estimate->second;
         }
+    }
 
-        double wait_time_estimate = std::max<double>(0, estimates[config_key] - simulation_date);
+    /**
+     * @brief Forget all cached start time estimates (to be called whenever the batch queue may have changed)
+     */
+    void ProxyWMS::clearStartTimeEstimates() {
+        this->start_time_estimates.clear();
+        this->wait_time_surface = nullptr;
+    }
 
-        return wait_time_estimate;
+    /**
+     * @brief Get the number of start time estimates that were found in the cache (over all instances)
+     * @return a number of cache hits
+     */
+    unsigned long ProxyWMS::getStartTimeEstimateCacheHits() {
+        return num_start_time_estimate_hits;
+    }
+
+    /**
+     * @brief Get the number of start time estimates that were requested from the batch service (over all instances)
+     * @return a number of cache misses
+     */
+    unsigned long ProxyWMS::getStartTimeEstimateCacheMisses() {
+        return num_start_time_estimate_misses;
     }
 
     unsigned long ProxyWMS::getStartLevel(std::set<PlaceHolderJob *> running_placeholder_jobs) {
+        auto dag = WorkflowUtil::getDagSnapshot(this->workflow);
         unsigned long start_level = 0;
-        for (unsigned long i = 0; i < this->workflow->getNumLevels(); i++) {
-            std::vector<WorkflowTask *> tasks_in_level = this->workflow->getTasksInTopLevelRange(i, i);
+        for (unsigned long i = 0; i < dag->getNumLevels(); i++) {
             bool all_completed = true;
-            for (auto task : tasks_in_level) {
-                if (task->getState() != WorkflowTask::State::COMPLETED) {
+            for (unsigned long t = dag->getLevelBegin(i); t < dag->getLevelEnd(i); t++) {
+                if (dag->getTask(t)->getState() != WorkflowTask::State::COMPLETED) {
                     all_completed = false;
+                    break;
                 }
             }
             if (all_completed) {
@@ -125,4 +369,12 @@ namespace wrench {
 
         return start_level;
     }
+
+    /**
+     * @brief Get the number of start time estimates that were answered by a wait time surface (over all instances)
+     * @return a number of estimates
+     */
+    unsigned long ProxyWMS::getStartTimeEstimateInterpolations() {
+        return num_start_time_estimate_interpolations;
+    }
 }
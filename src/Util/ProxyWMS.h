@@ -5,18 +5,23 @@
 #ifndef TASK_CLUSTERING_BATCH_SIMULATOR_PROXYWMS_H
 #define TASK_CLUSTERING_BATCH_SIMULATOR_PROXYWMS_H
 
+#include <deque>
+
 //#define EXECUTION_TIME_FUDGE_FACTOR 2.1
 
 namespace wrench {
 
     class PlaceHolderJob;
+    class WaitTimeSurface;
+    class WaitTimePredictor;
 
     class ProxyWMS {
 
     public:
 
         ProxyWMS(Workflow *workflow, std::shared_ptr<JobManager> job_manager,
-                 std::shared_ptr<BatchComputeService> batch_service);
+                 std::shared_ptr<BatchComputeService> batch_service,
+                 std::shared_ptr<WaitTimePredictor> wait_time_predictor);
 
         PlaceHolderJob *createAndSubmitPlaceholderJob(double requested_execution_time,
                                                       unsigned long requested_parallelism,
@@ -25,20 +30,63 @@ namespace wrench {
 
         void submitAllOneJobPerTask(double core_speed, unsigned long * num_jobs_in_system, unsigned long max_num_jobs);
 
+        void terminateJob(std::shared_ptr<WorkflowJob> job);
+
+        void notifyJobTermination(WorkflowJob *job);
+
+        void notifyTaskCompletion(WorkflowTask *task);
+
+        void resetReadyFrontier();
+
         static double findMaxDuration(std::set<PlaceHolderJob *> jobs);
 
         double estimateWaitTime(long parallelism, double makespan, double simulation_date, int *sequence);
 
+        std::vector<double> estimateWaitTimes(const std::vector<std::pair<unsigned long, double>> &configurations,
+                                              double simulation_date, int *sequence);
+
+        void buildWaitTimeSurface(unsigned long start_level, unsigned long end_level,
+                                  unsigned long max_num_nodes, double max_execution_time,
+                                  double simulation_date, int *sequence);
+
+        void clearStartTimeEstimates();
+
+        static unsigned long getStartTimeEstimateCacheHits();
+
+        static unsigned long getStartTimeEstimateCacheMisses();
+
+        static unsigned long getStartTimeEstimateInterpolations();
+
         unsigned long getStartLevel(std::set<PlaceHolderJob *> running_placeholder_jobs);
 
     private:
 
+        void requestStartTimeEstimates(const std::set<std::pair<unsigned long, unsigned long>> &buckets,
+                                       int *sequence);
+
         Workflow *workflow;
 
         std::shared_ptr<JobManager> job_manager;
 
         std::shared_ptr<BatchComputeService> batch_service;
 
+        std::shared_ptr<WaitTimePredictor> wait_time_predictor;
+
+        // READY tasks not yet submitted individually (may hold duplicates and tasks submitted since)
+        std::deque<WorkflowTask *> ready_frontier;
+        bool ready_frontier_seeded = false;
+
+        // Start time estimates, by (number of nodes, requested minutes), made at start_time_estimates_date
+        std::map<std::pair<unsigned long, unsigned long>, double> start_time_estimates;
+        double start_time_estimates_date = -1.0;
+
+        // Answers the estimates that are not cached, if built at start_time_estimates_date
+        std::shared_ptr<WaitTimeSurface> wait_time_surface;
+
+        static unsigned long num_start_time_estimate_hits;
+        static unsigned long num_start_time_estimate_misses;
+        static unsigned long num_start_time_estimate_interpolations;
+
     };
 }
 
@@ -0,0 +1,104 @@
+/**
+ * Copyright (c) 2017. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+
+#include <algorithm>
+
+#include "QueryProfiler.h"
+
+
+namespace wrench {
+
+    std::vector<std::string> QueryProfiler::phases;
+    std::map<std::string, QueryProfiler::PhaseStats> QueryProfiler::phase_stats;
+
+    /**
+     * @brief Constructor: enter a phase
+     * @param name: the phase's name
+     */
+    QueryProfiler::Phase::Phase(std::string name) {
+        this->name = name;
+        this->outermost = (std::find(phases.begin(), phases.end(), name) == phases.end());
+        this->start = std::chrono::steady_clock::now();
+        phases.push_back(name);
+    }
+
+    /**
+     * @brief Destructor: leave the phase (the time spent in a phase is only counted once for nested phases
+     *        of the same name)
+     */
+    QueryProfiler::Phase::~Phase() {
+        phases.pop_back();
+        if (this->outermost) {
+            phase_stats[this->name].phase_seconds +=
+                    std::chrono::duration<double>(std::chrono::steady_clock::now() - this->start).count();
+        }
+    }
+
+    /**
+     * @brief Constructor: start a query
+     * @param type: the query's type
+     * @param num_configurations: the number of job configurations in the query
+     */
+    QueryProfiler::Query::Query(QueryType type, unsigned long num_configurations) {
+        this->type = type;
+        this->num_configurations = num_configurations;
+        this->start = std::chrono::steady_clock::now();
+    }
+
+    /**
+     * @brief Destructor: record the query in the current phase
+     */
+    QueryProfiler::Query::~Query() {
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - this->start).count();
+        PhaseStats &stats = getCurrentPhaseStats();
+        if (this->type == HEURISTIC_QUERY) {
+            stats.num_queries++;
+            stats.num_query_configurations += this->num_configurations;
+            stats.query_seconds += seconds;
+            stats.max_query_seconds = std::max<double>(stats.max_query_seconds, seconds);
+        } else {
+            stats.num_requests++;
+            stats.num_request_configurations += this->num_configurations;
+            stats.request_seconds += seconds;
+        }
+    }
+
+    /**
+     * @brief Get the statistics of the innermost phase in scope
+     * @return phase statistics
+     */
+    QueryProfiler::PhaseStats &QueryProfiler::getCurrentPhaseStats() {
+        return phase_stats[phases.empty() ? "other" : phases.back()];
+    }
+
+    /**
+     * @brief Get the statistics of all phases
+     * @return a JSON object, with one entry per phase
+     */
+    nlohmann::json QueryProfiler::toJson() {
+        nlohmann::json json = nlohmann::json::object();
+        for (auto const &entry : phase_stats) {
+            auto const &stats = entry.second;
+            nlohmann::json &phase_json = json[entry.first];
+            phase_json["queries"] = stats.num_queries;
+            phase_json["configurations"] = stats.num_query_configurations;
+            phase_json["configurations_per_query"] =
+                    (stats.num_queries > 0) ? (double) stats.num_query_configurations / stats.num_queries : 0.0;
+            phase_json["query_seconds"] = stats.query_seconds;
+            phase_json["max_query_seconds"] = stats.max_query_seconds;
+            phase_json["scheduler_requests"] = stats.num_requests;
+            phase_json["scheduler_configurations"] = stats.num_request_configurations;
+            phase_json["scheduler_seconds"] = stats.request_seconds;
+            phase_json["phase_seconds"] = stats.phase_seconds;
+        }
+        return json;
+    }
+
+};
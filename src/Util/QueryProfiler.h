@@ -0,0 +1,105 @@
+/**
+ * Copyright (c) 2017. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+
+#ifndef TASK_CLUSTERING_BATCH_SIMULATOR_QUERYPROFILER_H
+#define TASK_CLUSTERING_BATCH_SIMULATOR_QUERYPROFILER_H
+
+
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace wrench {
+
+    /**
+     * @brief Counts and times the wait time queries of the scheduling heuristics, by algorithm phase
+     *
+     * Phases (e.g., "grouping", "parallelism", "leeway") are scoped with QueryProfiler::Phase objects,
+     * and queries with QueryProfiler::Query objects. A query is charged to the innermost phase in scope
+     * (or to "other").
+     */
+    class QueryProfiler {
+
+    public:
+
+        /** @brief The kinds of queries */
+        enum QueryType {
+            /** @brief A wait time query made by a heuristic (that may be answered from a cache) */
+            HEURISTIC_QUERY,
+            /** @brief A request for start time estimates sent to the wait time predictor */
+            SCHEDULER_REQUEST
+        };
+
+        /**
+         * @brief An algorithm phase, in scope for the lifetime of the object
+         */
+        class Phase {
+
+        public:
+
+            explicit Phase(std::string name);
+
+            ~Phase();
+
+        private:
+
+            std::string name;
+            bool outermost;
+            std::chrono::steady_clock::time_point start;
+
+        };
+
+        /**
+         * @brief A query, timed over the lifetime of the object
+         */
+        class Query {
+
+        public:
+
+            Query(QueryType type, unsigned long num_configurations);
+
+            ~Query();
+
+        private:
+
+            QueryType type;
+            unsigned long num_configurations;
+            std::chrono::steady_clock::time_point start;
+
+        };
+
+        static nlohmann::json toJson();
+
+    private:
+
+        struct PhaseStats {
+            unsigned long num_queries = 0;
+            unsigned long num_query_configurations = 0;
+            double query_seconds = 0;
+            double max_query_seconds = 0;
+            unsigned long num_requests = 0;
+            unsigned long num_request_configurations = 0;
+            double request_seconds = 0;
+            double phase_seconds = 0;
+        };
+
+        static PhaseStats &getCurrentPhaseStats();
+
+        static std::vector<std::string> phases;
+        static std::map<std::string, PhaseStats> phase_stats;
+
+    };
+
+};
+
+
+#endif //TASK_CLUSTERING_BATCH_SIMULATOR_QUERYPROFILER_H
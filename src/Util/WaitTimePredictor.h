@@ -0,0 +1,61 @@
+/**
+ * Copyright (c) 2017. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+
+#ifndef TASK_CLUSTERING_BATCH_SIMULATOR_WAITTIMEPREDICTOR_H
+#define TASK_CLUSTERING_BATCH_SIMULATOR_WAITTIMEPREDICTOR_H
+
+
+#include <map>
+#include <set>
+#include <string>
+#include <tuple>
+
+namespace wrench {
+
+    class WorkflowJob;
+
+    /**
+     * @brief A source of start time estimates for batch job configurations
+     */
+    class WaitTimePredictor {
+
+    public:
+
+        virtual ~WaitTimePredictor() = default;
+
+        /**
+         * @brief Estimate the start dates of job configurations submitted at the current simulation date
+         * @param job_configurations: (unique key, number of nodes, number of cores per node, requested execution time) tuples
+         * @return start date estimates, by key
+         */
+        virtual std::map<std::string, double>
+        getStartTimeEstimates(std::set<std::tuple<std::string, unsigned long, unsigned long, double>> job_configurations) = 0;
+
+        /**
+         * @brief Notify the predictor that a job was submitted to the batch service at the current simulation date
+         * @param job: the job
+         * @param num_nodes: the job's number of nodes
+         * @param requested_execution_time: the job's requested execution time
+         */
+        virtual void notifyJobSubmission(WorkflowJob *job, unsigned long num_nodes, double requested_execution_time) {}
+
+        /**
+         * @brief Notify the predictor that a job submitted to the batch service left it at the current simulation
+         *        date (it completed, failed, expired, or was terminated, possibly before it started)
+         * @param job: the job (that may not have been submitted to the batch service)
+         */
+        virtual void notifyJobTermination(WorkflowJob *job) {}
+
+    };
+
+};
+
+
+#endif //TASK_CLUSTERING_BATCH_SIMULATOR_WAITTIMEPREDICTOR_H
@@ -0,0 +1,121 @@
+/**
+ * Copyright (c) 2017. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "WaitTimeSurface.h"
+
+
+namespace wrench {
+
+    /**
+     * @brief Constructor
+     * @param node_counts: the grid's numbers of nodes, in increasing order
+     * @param minutes: the grid's requested minutes, in increasing order
+     * @param start_times: the start time estimates, row-major (the estimate for node_counts[i] and
+     *        minutes[j] is start_times[i * minutes.size() + j])
+     *
+     * @throw std::invalid_argument
+     */
+    WaitTimeSurface::WaitTimeSurface(std::vector<unsigned long> node_counts, std::vector<unsigned long> minutes,
+                                     std::vector<double> start_times) {
+
+        if (node_counts.empty() or minutes.empty() or
+            (start_times.size() != node_counts.size() * minutes.size())) {
+            throw std::invalid_argument("WaitTimeSurface::WaitTimeSurface(): invalid grid");
+        }
+        if ((not std::is_sorted(node_counts.begin(), node_counts.end())) or
+            (not std::is_sorted(minutes.begin(), minutes.end()))) {
+            throw std::invalid_argument("WaitTimeSurface::WaitTimeSurface(): grid axes must be sorted");
+        }
+
+        this->node_counts = node_counts;
+        this->minutes = minutes;
+        this->start_times = start_times;
+
+        // Make the estimates monotone in both dimensions
+        unsigned long num_minutes = this->minutes.size();
+        for (unsigned long i = 0; i < this->node_counts.size(); i++) {
+            for (unsigned long j = 0; j < num_minutes; j++) {
+                double &start_time = this->start_times[i * num_minutes + j];
+                if (i > 0) {
+                    start_time = std::max<double>(start_time, this->start_times[(i - 1) * num_minutes + j]);
+                }
+                if (j > 0) {
+                    start_time = std::max<double>(start_time, this->start_times[i * num_minutes + j - 1]);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Get log-spaced requested minutes, from 1 to max_minutes (each about 25% more than the previous one)
+     * @param max_minutes: the largest number of minutes
+     * @return increasing numbers of minutes
+     */
+    std::vector<unsigned long> WaitTimeSurface::getLogSpacedMinutes(unsigned long max_minutes) {
+        std::vector<unsigned long> minutes;
+        unsigned long m = 1;
+        while (m < max_minutes) {
+            minutes.push_back(m);
+            m = std::max<unsigned long>(m + 1, (unsigned long) std::ceil(m * 1.25));
+        }
+        minutes.push_back(std::max<unsigned long>(max_minutes, 1));
+        return minutes;
+    }
+
+    /**
+     * @brief Get the grid's numbers of nodes
+     * @return increasing numbers of nodes
+     */
+    const std::vector<unsigned long> &WaitTimeSurface::getNodeCounts() const {
+        return this->node_counts;
+    }
+
+    /**
+     * @brief Get the grid's requested minutes
+     * @return increasing numbers of minutes
+     */
+    const std::vector<unsigned long> &WaitTimeSurface::getMinutes() const {
+        return this->minutes;
+    }
+
+    /**
+     * @brief Check whether a job configuration is within the grid's range
+     * @param num_nodes: a number of nodes
+     * @param minutes: a number of requested minutes
+     * @return true or false
+     */
+    bool WaitTimeSurface::covers(unsigned long num_nodes, unsigned long minutes) const {
+        return (num_nodes <= this->node_counts.back()) and (minutes <= this->minutes.back());
+    }
+
+    /**
+     * @brief Estimate the start time of a job configuration within the grid's range
+     * @param num_nodes: a number of nodes
+     * @param minutes: a number of requested minutes
+     * @return a start time estimate
+     *
+     * @throw std::invalid_argument
+     */
+    double WaitTimeSurface::getStartTime(unsigned long num_nodes, unsigned long minutes) const {
+        if (not this->covers(num_nodes, minutes)) {
+            throw std::invalid_argument("WaitTimeSurface::getStartTime(): configuration out of the grid's range");
+        }
+        unsigned long i = std::lower_bound(this->node_counts.begin(), this->node_counts.end(), num_nodes) -
+                          this->node_counts.begin();
+        unsigned long j = std::lower_bound(this->minutes.begin(), this->minutes.end(), minutes) -
+                          this->minutes.begin();
+        return this->start_times[i * this->minutes.size() + j];
+    }
+
+};
@@ -0,0 +1,60 @@
+/**
+ * Copyright (c) 2017. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+
+#ifndef TASK_CLUSTERING_BATCH_SIMULATOR_WAITTIMESURFACE_H
+#define TASK_CLUSTERING_BATCH_SIMULATOR_WAITTIMESURFACE_H
+
+
+#include <vector>
+
+namespace wrench {
+
+    /**
+     * @brief The start time estimates, all made at the same date, of a grid of job configurations
+     *        (number of nodes x requested minutes), from which the start time of any configuration
+     *        within the grid's range is estimated conservatively
+     *
+     * A job that asks for more nodes or more time cannot start earlier, so the estimate of a
+     * configuration is that of the closest grid configuration that asks for at least as many
+     * nodes and minutes. Grid estimates are first made monotone (each is raised to the maximum of
+     * the estimates of the smaller configurations), so that estimates never decrease when a
+     * configuration grows.
+     */
+    class WaitTimeSurface {
+
+    public:
+
+        WaitTimeSurface(std::vector<unsigned long> node_counts, std::vector<unsigned long> minutes,
+                        std::vector<double> start_times);
+
+        static std::vector<unsigned long> getLogSpacedMinutes(unsigned long max_minutes);
+
+        const std::vector<unsigned long> &getNodeCounts() const;
+
+        const std::vector<unsigned long> &getMinutes() const;
+
+        bool covers(unsigned long num_nodes, unsigned long minutes) const;
+
+        double getStartTime(unsigned long num_nodes, unsigned long minutes) const;
+
+    private:
+
+        std::vector<unsigned long> node_counts;
+        std::vector<unsigned long> minutes;
+
+        // Row-major: start_times[i * minutes.size() + j] is for node_counts[i] and minutes[j]
+        std::vector<double> start_times;
+
+    };
+
+};
+
+
+#endif //TASK_CLUSTERING_BATCH_SIMULATOR_WAITTIMESURFACE_H
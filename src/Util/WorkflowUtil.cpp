@@ -17,15 +17,251 @@
 #include<mach/mach.h>
 #endif
 #include <unordered_map>
+#include <algorithm>
+#include <functional>
+#include <list>
 
 #include "WorkflowUtil.h"
+#include "DagSnapshot.h"
 
 XBT_LOG_NEW_DEFAULT_CATEGORY(workflow_util, "Log category for Workflow Util");
 
 
 namespace wrench {
 
-    std::unordered_map<WorkflowTask*, std::vector<WorkflowTask*>> lineage;
+    /**
+     * @brief Per-workflow dependency cache: the parents of each task, kept up to date by the
+     *        WorkflowUtil mutation wrappers, and the DAG snapshot built from them
+     */
+    struct DependencyCache {
+        unsigned long version = 0;
+        std::unordered_map<WorkflowTask *, std::vector<WorkflowTask *>> task_parents;
+        std::shared_ptr<DagSnapshot> dag;
+    };
+
+    std::unordered_map<Workflow *, DependencyCache> dependency_caches;
+
+    /**
+     * @brief Key of a makespan estimate: a fingerprint of the task set (the sum of the tasks' DAG
+     *        snapshot keys), the number of tasks, the number of hosts, and the core speed
+     */
+    struct MakespanCacheKey {
+        uint64_t fingerprint;
+        unsigned long num_tasks;
+        unsigned long num_hosts;
+        double core_speed;
+
+        bool operator==(const MakespanCacheKey &other) const {
+            return (this->fingerprint == other.fingerprint) and (this->num_tasks == other.num_tasks) and
+                   (this->num_hosts == other.num_hosts) and (this->core_speed == other.core_speed);
+        }
+    };
+
+    struct MakespanCacheKeyHash {
+        size_t operator()(const MakespanCacheKey &key) const {
+            uint64_t h = key.fingerprint;
+            h ^= key.num_hosts * 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+            h ^= key.num_tasks * 0xc2b2ae3d27d4eb4fULL + (h << 6) + (h >> 2);
+            h ^= std::hash<double>()(key.core_speed) + (h << 6) + (h >> 2);
+            return (size_t) h;
+        }
+    };
+
+    /**
+     * @brief Bounded, least-recently-used cache of makespan estimates
+     */
+    struct MakespanCache {
+        unsigned long capacity = 65536;
+        unsigned long hits = 0;
+        unsigned long misses = 0;
+        std::list<std::pair<MakespanCacheKey, double>> entries;
+        std::unordered_map<MakespanCacheKey, std::list<std::pair<MakespanCacheKey, double>>::iterator, MakespanCacheKeyHash> index;
+
+        bool lookup(const MakespanCacheKey &key, double *makespan) {
+            auto it = this->index.find(key);
+            if (it == this->index.end()) {
+                this->misses++;
+                return false;
+            }
+            this->hits++;
+            this->entries.splice(this->entries.begin(), this->entries, it->second);
+            *makespan = it->second->second;
+            return true;
+        }
+
+        void insert(const MakespanCacheKey &key, double makespan) {
+            if (this->capacity == 0) {
+                return;
+            }
+            if (this->entries.size() < this->capacity) {
+                this->entries.push_front(std::make_pair(key, makespan));
+            } else {
+                // Evict the least recently used estimate, and reuse its list node
+                this->index.erase(this->entries.back().first);
+                this->entries.splice(this->entries.begin(), this->entries, std::prev(this->entries.end()));
+                this->entries.front() = std::make_pair(key, makespan);
+            }
+            this->index[key] = this->entries.begin();
+        }
+    };
+
+    MakespanCache makespan_cache;
+
+    /**
+     * @brief Build the makespan cache key of a set of tasks
+     * @param dag: the workflow's DAG snapshot
+     * @param tasks: the indices of the tasks
+     * @param num_hosts: a number of hosts
+     * @param core_speed: the core speed
+     * @return a key
+     */
+    static MakespanCacheKey makespanCacheKey(const DagSnapshot &dag, const std::vector<unsigned long> &tasks,
+                                             unsigned long num_hosts, double core_speed) {
+        MakespanCacheKey key;
+        key.fingerprint = 0;
+        for (auto task : tasks) {
+            key.fingerprint += dag.getTaskKey(task);
+        }
+        key.num_tasks = tasks.size();
+        key.num_hosts = num_hosts;
+        key.core_speed = core_speed;
+        return key;
+    }
+
+    /**
+     * @brief The part of a list schedule that does not depend on the number of hosts
+     */
+    struct ListScheduleSetup {
+        // Task indices, by decreasing priority
+        std::vector<unsigned long> sorted_tasks;
+        // Position of each DAG task in sorted_tasks (ULONG_MAX if not in the set)
+        std::vector<unsigned long> positions;
+        // Number of parents of each task in the set
+        std::vector<unsigned long> num_parents;
+    };
+
+    /**
+     * @brief Scratch space of the makespan estimator, which is reused from one call to the next
+     *        (vectors are cleared, never freed) so that, once it has grown to the size of the
+     *        largest estimate, estimates do not allocate memory
+     */
+    struct EstimatorScratch {
+        // List schedule setup. Between calls, all entries of setup.positions are ULONG_MAX
+        // except those of the tasks in setup.sorted_tasks.
+        ListScheduleSetup setup;
+        // Task indices of a level range
+        std::vector<unsigned long> level_range_tasks;
+        // List schedule state: pending parent counts, and the ready, running and deferred tasks
+        std::vector<unsigned long> num_pending_parents;
+        std::vector<unsigned long> ready_tasks;
+        std::vector<std::pair<double, unsigned long>> running_tasks;
+        std::vector<unsigned long> deferred_tasks;
+        // Critical path computations
+        std::vector<unsigned long> path_tasks;
+        std::vector<double> finish_times;
+    };
+
+    static thread_local EstimatorScratch estimator_scratch;
+
+    /**
+     * @brief Get the indices of the tasks in a range of levels, in the estimator's scratch space
+     * @param dag: the workflow's DAG snapshot
+     * @param start_level: the first level
+     * @param end_level: the last level
+     * @return the task indices (valid until the next call)
+     */
+    static const std::vector<unsigned long> &getLevelRangeTasks(const DagSnapshot &dag,
+                                                                unsigned long start_level, unsigned long end_level) {
+        std::vector<unsigned long> &indices = estimator_scratch.level_range_tasks;
+        indices.clear();
+        if ((start_level > end_level) or (start_level >= dag.getNumLevels())) {
+            return indices;
+        }
+        end_level = std::min<unsigned long>(end_level, dag.getNumLevels() - 1);
+        for (unsigned long i = dag.getLevelBegin(start_level); i < dag.getLevelEnd(end_level); i++) {
+            indices.push_back(i);
+        }
+        return indices;
+    }
+
+    static void setUpListSchedule(const DagSnapshot &dag, const std::vector<unsigned long> &tasks,
+                                  ListScheduleSetup &setup);
+
+    /**
+     * @brief Compute makespan bounds from the critical path length and the total work of a set of tasks
+     * @param critical_path: the critical path length
+     * @param work: the total work
+     * @param num_tasks: the number of tasks
+     * @param num_hosts: the number of hosts
+     * @return a (lower bound, upper bound) pair
+     */
+    static std::pair<double, double> boundMakespan(double critical_path, double work,
+                                                   unsigned long num_tasks, unsigned long num_hosts) {
+        if (num_hosts >= num_tasks) {
+            return std::make_pair(critical_path, critical_path);
+        }
+
+        // The work-based terms are summed in a different order than the schedule's dates, hence the slack
+        double lower_bound = std::max<double>(critical_path, (work / num_hosts) * (1.0 - 1e-9));
+        double upper_bound = (work / num_hosts + (1.0 - 1.0 / num_hosts) * critical_path) * (1.0 + 1e-9);
+        return std::make_pair(lower_bound, upper_bound);
+    }
+
+    /**
+     * @brief Compute the critical path length and the total work of a set of tasks, in seconds
+     * @param dag: the workflow's DAG snapshot
+     * @param tasks: the indices of the tasks
+     * @param core_speed: the core speed
+     * @param work: set to the sum of the tasks' execution times
+     * @param num_tasks: set to the number of (distinct) tasks
+     * @return the length of the longest path in the set, which is also the makespan of the list
+     *         schedule of the set when there are at least as many hosts as tasks
+     */
+    static double criticalPathLength(const DagSnapshot &dag, const std::vector<unsigned long> &tasks,
+                                     double core_speed, double *work, unsigned long *num_tasks) {
+        // Indices are ordered level by level, so parents come before their children
+        std::vector<unsigned long> &sorted_tasks = estimator_scratch.path_tasks;
+        sorted_tasks.assign(tasks.begin(), tasks.end());
+        std::sort(sorted_tasks.begin(), sorted_tasks.end());
+        sorted_tasks.erase(std::unique(sorted_tasks.begin(), sorted_tasks.end()), sorted_tasks.end());
+
+        std::vector<double> &finish_times = estimator_scratch.finish_times;
+        finish_times.assign(sorted_tasks.size(), 0.0);
+        double critical_path = 0.0;
+        *work = 0.0;
+        for (unsigned long k = 0; k < sorted_tasks.size(); k++) {
+            unsigned long task = sorted_tasks[k];
+            double start_time = 0.0;
+            for (auto parent = dag.getParentsBegin(task); parent != dag.getParentsEnd(task); parent++) {
+                auto it = std::lower_bound(sorted_tasks.begin(), sorted_tasks.begin() + k, *parent);
+                if ((it != sorted_tasks.begin() + k) and (*it == *parent)) {
+                    start_time = std::max<double>(start_time, finish_times[it - sorted_tasks.begin()]);
+                }
+            }
+            finish_times[k] = start_time + dag.getFlops(task) / core_speed;
+            critical_path = std::max<double>(critical_path, finish_times[k]);
+            *work += dag.getFlops(task) / core_speed;
+        }
+
+        *num_tasks = sorted_tasks.size();
+        return critical_path;
+    }
+
+    static double runListSchedule(const DagSnapshot &dag, const ListScheduleSetup &setup,
+                                  unsigned long num_hosts, double core_speed, bool *host_limited);
+
+    /**
+     * @brief Fill a dependency cache from scratch
+     * @param cache: the cache
+     * @param workflow: the workflow
+     */
+    static void fillDependencyCache(DependencyCache &cache, Workflow *workflow) {
+        cache.task_parents.clear();
+        for (auto task : workflow->getTasks()) {
+            cache.task_parents[task] = task->getParents();
+        }
+        cache.version++;
+    }
 
 #ifdef PRINT_RAM_MACOSX
     void WorkflowUtil::printRAM() {
@@ -47,6 +283,99 @@ namespace wrench {
     void WorkflowUtil::printRAM() {}
 #endif
 
+    /**
+     * @brief Get the DAG snapshot of a workflow. The snapshot is cached, and rebuilt from the cached
+     *        dependencies only when the workflow was modified (through the WorkflowUtil mutation
+     *        methods) since it was built. The rebuild is a full one, in O(V log(V) + E), done once however
+     *        many modifications were made. Direct modifications of the workflow that do not change its
+     *        number of tasks (e.g., Workflow::addControlDependency() calls) go unnoticed.
+     * @param workflow: a workflow
+     * @return a DAG snapshot
+     */
+    std::shared_ptr<DagSnapshot> WorkflowUtil::getDagSnapshot(Workflow *workflow) {
+        auto it = dependency_caches.find(workflow);
+        if (it == dependency_caches.end()) {
+            it = dependency_caches.insert(std::make_pair(workflow, DependencyCache())).first;
+            fillDependencyCache(it->second, workflow);
+        }
+        DependencyCache &cache = it->second;
+
+        // The workflow was modified behind our back: start over
+        if (cache.task_parents.size() != workflow->getNumberOfTasks()) {
+            WRENCH_INFO("Workflow modified without going through WorkflowUtil, rebuilding its dependency cache");
+            fillDependencyCache(cache, workflow);
+        }
+
+        if ((cache.dag == nullptr) or (cache.dag->getVersion() != cache.version)) {
+            cache.dag = std::make_shared<DagSnapshot>(workflow, cache.task_parents, cache.version);
+        }
+        return cache.dag;
+    }
+
+    /**
+     * @brief Add a task to a workflow, and update the workflow's dependency cache
+     * @param workflow: the workflow
+     * @param id: the task's id
+     * @param flops: the task's flops
+     * @param min_num_cores: the task's minimum number of cores
+     * @param max_num_cores: the task's maximum number of cores
+     * @param parallel_efficiency: the task's parallel efficiency
+     * @return the new task
+     */
+    WorkflowTask *WorkflowUtil::addTask(Workflow *workflow, std::string id, double flops,
+                                        unsigned long min_num_cores, unsigned long max_num_cores,
+                                        double parallel_efficiency) {
+        WorkflowTask *task = workflow->addTask(id, flops, min_num_cores, max_num_cores, parallel_efficiency);
+
+        auto it = dependency_caches.find(workflow);
+        if (it != dependency_caches.end()) {
+            it->second.task_parents[task] = {};
+            it->second.version++;
+        }
+        return task;
+    }
+
+    /**
+     * @brief Remove a task from a workflow, and update the workflow's dependency cache
+     * @param workflow: the workflow
+     * @param task: the task
+     */
+    void WorkflowUtil::removeTask(Workflow *workflow, WorkflowTask *task) {
+        auto it = dependency_caches.find(workflow);
+        if (it != dependency_caches.end()) {
+            auto &task_parents = it->second.task_parents;
+            for (auto child : workflow->getTaskChildren(task)) {
+                auto &child_parents = task_parents[child];
+                child_parents.erase(std::remove(child_parents.begin(), child_parents.end(), task),
+                                    child_parents.end());
+            }
+            task_parents.erase(task);
+            it->second.version++;
+        }
+
+        workflow->removeTask(task);
+    }
+
+    /**
+     * @brief Add a control dependency between two tasks of a workflow, and update the workflow's
+     *        dependency cache
+     * @param workflow: the workflow
+     * @param parent: the parent task
+     * @param child: the child task
+     */
+    void WorkflowUtil::addControlDependency(Workflow *workflow, WorkflowTask *parent, WorkflowTask *child) {
+        workflow->addControlDependency(parent, child);
+
+        auto it = dependency_caches.find(workflow);
+        if (it != dependency_caches.end()) {
+            auto &child_parents = it->second.task_parents[child];
+            if (std::find(child_parents.begin(), child_parents.end(), parent) == child_parents.end()) {
+                child_parents.push_back(parent);
+            }
+            it->second.version++;
+        }
+    }
+
     /**
      * @brief Estimate a workflow's makespan
      * @param tasks: a set of tasks. For any task that has parents outside of this set, it is assumed that
@@ -56,126 +385,449 @@ namespace wrench {
      * @param core_speed
      * @return
      */
-    double WorkflowUtil::estimateMakespan(std::vector<WorkflowTask *> tasks,
+    double WorkflowUtil::estimateMakespan(const std::vector<WorkflowTask *> &tasks,
                                           unsigned long num_hosts, double core_speed) {
 
         if (tasks.size() == 0) {
             return 0.0;
         }
 
-        if (lineage.empty()) {
-            auto workflow = (*tasks.begin())->getWorkflow();
-            for (auto task : workflow->getTasks()) {
-                std::vector<WorkflowTask *> parents = task->getParents();
-                lineage[task] = parents;
-            }
+        auto dag = getDagSnapshot((*tasks.begin())->getWorkflow());
+
+        std::vector<unsigned long> task_indices;
+        task_indices.reserve(tasks.size());
+        for (auto task : tasks) {
+            task_indices.push_back(dag->getIndex(task));
+        }
+
+        return estimateMakespan(*dag, task_indices, num_hosts, core_speed);
+    }
+
+    /**
+     * @brief Estimate the makespan of the tasks in a range of workflow levels
+     * @param dag: the workflow's DAG snapshot
+     * @param start_level: the first level
+     * @param end_level: the last level
+     * @param num_hosts
+     * @param core_speed
+     * @return
+     */
+    double WorkflowUtil::estimateMakespan(const DagSnapshot &dag, unsigned long start_level, unsigned long end_level,
+                                          unsigned long num_hosts, double core_speed) {
+        return estimateMakespan(dag, getLevelRangeTasks(dag, start_level, end_level), num_hosts, core_speed);
+    }
+
+    /**
+     * @brief Estimate a workflow's makespan
+     * @param dag: the workflow's DAG snapshot
+     * @param tasks: the indices of a set of tasks. For any task that has parents outside of this set, it is
+     *         assumed that those parents are completed. For instance, a task with no parents in this set is
+     *         assumed ready. If no task is given, then makespan will be zero.
+     * @param num_hosts
+     * @param core_speed
+     * @return
+     */
+    double WorkflowUtil::estimateMakespan(const DagSnapshot &dag, const std::vector<unsigned long> &tasks,
+                                          unsigned long num_hosts, double core_speed) {
+
+        if (tasks.size() == 0) {
+            return 0.0;
         }
 
         if (num_hosts == 0) {
             throw std::runtime_error("Cannot estimate makespan with 0 hosts!");
         }
 
-//        // Sort the tasks
-//        std::sort(tasks.begin(), tasks.end(),
-//                  [](const WorkflowTask * t1, const WorkflowTask * t2) -> bool {
-//
-//                      if (t1->getFlops() == t2->getFlops()) {
-//                          return (t1->getID() > t2->getID());
-//                      }
-//                      return (t1->getFlops() > t2->getFlops());
-//                  });
+        // With at least one host per task, the makespan is the critical path length
+        if (num_hosts >= tasks.size()) {
+            double work;
+            unsigned long num_tasks;
+            return criticalPathLength(dag, tasks, core_speed, &work, &num_tasks);
+        }
+
+        MakespanCacheKey key = makespanCacheKey(dag, tasks, num_hosts, core_speed);
+
+        double makespan;
+        if (makespan_cache.lookup(key, &makespan)) {
+            return makespan;
+        }
+
+        ListScheduleSetup &setup = estimator_scratch.setup;
+        setUpListSchedule(dag, tasks, setup);
+        bool host_limited;
+        makespan = runListSchedule(dag, setup, num_hosts, core_speed, &host_limited);
+        makespan_cache.insert(key, makespan);
+        return makespan;
+    }
 
-        // Initialize host idle dates
-        double idle_date[num_hosts];
-        memset(idle_date, 0, sizeof(double)*num_hosts);
+    /**
+     * @brief Estimate a workflow's makespan for every number of hosts from 1 to max_hosts
+     * @param tasks: a set of tasks (see WorkflowUtil::estimateMakespan())
+     * @param max_hosts: the maximum number of hosts
+     * @param core_speed
+     * @return a vector of max_hosts makespans, the i-th of which is for i+1 hosts
+     */
+    std::vector<double> WorkflowUtil::estimateMakespanCurve(const std::vector<WorkflowTask *> &tasks,
+                                                            unsigned long max_hosts, double core_speed) {
+        if (tasks.size() == 0) {
+            return std::vector<double>(max_hosts, 0.0);
+        }
 
-        unsigned long num_tasks = tasks.size();
+        auto dag = getDagSnapshot((*tasks.begin())->getWorkflow());
 
-        std::set<WorkflowTask *> tasks_to_schedule;
+        std::vector<unsigned long> task_indices;
+        task_indices.reserve(tasks.size());
         for (auto task : tasks) {
-            tasks_to_schedule.insert(task);
+            task_indices.push_back(dag->getIndex(task));
         }
 
-        // Create a list of "fake" tasks
-        std::unordered_map<WorkflowTask *, double> fake_tasks;  // WorkflowTask, completion time
+        return estimateMakespanCurve(*dag, task_indices, max_hosts, core_speed);
+    }
+
+    /**
+     * @brief Estimate the makespan of the tasks in a range of workflow levels for every number
+     *        of hosts from 1 to max_hosts
+     * @param dag: the workflow's DAG snapshot
+     * @param start_level: the first level
+     * @param end_level: the last level
+     * @param max_hosts: the maximum number of hosts
+     * @param core_speed
+     * @return a vector of max_hosts makespans, the i-th of which is for i+1 hosts
+     */
+    std::vector<double> WorkflowUtil::estimateMakespanCurve(const DagSnapshot &dag,
+                                                            unsigned long start_level, unsigned long end_level,
+                                                            unsigned long max_hosts, double core_speed) {
+        return estimateMakespanCurve(dag, getLevelRangeTasks(dag, start_level, end_level), max_hosts, core_speed);
+    }
 
-        // Insert all fake_tasks
-        for (auto task : tasks_to_schedule) {
-            fake_tasks[task] = -1.0;
+    /**
+     * @brief Estimate a workflow's makespan for every number of hosts from 1 to max_hosts. The
+     *        list schedule is set up once, and the curve is filled in as soon as a schedule never
+     *        makes a ready task wait for a host (more hosts would then not change it).
+     * @param dag: the workflow's DAG snapshot
+     * @param tasks: the indices of a set of tasks (see WorkflowUtil::estimateMakespan())
+     * @param max_hosts: the maximum number of hosts
+     * @param core_speed
+     * @return a vector of max_hosts makespans, the i-th of which is for i+1 hosts
+     */
+    std::vector<double> WorkflowUtil::estimateMakespanCurve(const DagSnapshot &dag,
+                                                            const std::vector<unsigned long> &tasks,
+                                                            unsigned long max_hosts, double core_speed) {
+
+        std::vector<double> makespans(max_hosts, 0.0);
+
+        if (tasks.size() == 0) {
+            return makespans;
         }
 
+        ListScheduleSetup &setup = estimator_scratch.setup;
+        bool set_up = false;
+
+        for (unsigned long num_hosts = 1; num_hosts <= max_hosts; num_hosts++) {
+            MakespanCacheKey key = makespanCacheKey(dag, tasks, num_hosts, core_speed);
+            if (makespan_cache.lookup(key, &makespans[num_hosts - 1])) {
+                continue;
+            }
+
+            if (not set_up) {
+                setUpListSchedule(dag, tasks, setup);
+                set_up = true;
+            }
+            bool host_limited;
+            makespans[num_hosts - 1] = runListSchedule(dag, setup, num_hosts, core_speed, &host_limited);
+            makespan_cache.insert(key, makespans[num_hosts - 1]);
+
+            if (not host_limited) {
+                std::fill(makespans.begin() + num_hosts, makespans.end(), makespans[num_hosts - 1]);
+                break;
+            }
+        }
+
+        return makespans;
+    }
+
+    /**
+     * @brief Compute cheap lower and upper bounds on the makespan that WorkflowUtil::estimateMakespan()
+     *        would return, in O(V+E): the lower bound is max(critical path, work / hosts), and the upper
+     *        bound is Graham's list scheduling bound, work / hosts + (1 - 1 / hosts) * critical path.
+     *        When there are at least as many hosts as tasks, both bounds are the (exact) critical path length.
+     * @param dag: the workflow's DAG snapshot
+     * @param tasks: the indices of a set of tasks (see WorkflowUtil::estimateMakespan())
+     * @param num_hosts
+     * @param core_speed
+     * @return a (lower bound, upper bound) pair
+     */
+    std::pair<double, double> WorkflowUtil::makespanBounds(const DagSnapshot &dag, const std::vector<unsigned long> &tasks,
+                                                           unsigned long num_hosts, double core_speed) {
+        if (tasks.size() == 0) {
+            return std::make_pair(0.0, 0.0);
+        }
+
+        if (num_hosts == 0) {
+            throw std::runtime_error("Cannot bound makespan with 0 hosts!");
+        }
+
+        double work;
+        unsigned long num_tasks;
+        double critical_path = criticalPathLength(dag, tasks, core_speed, &work, &num_tasks);
+
+        return boundMakespan(critical_path, work, num_tasks, num_hosts);
+    }
+
+    /**
+     * @brief Compute cheap lower and upper bounds on the makespan of the tasks in a range of workflow
+     *        levels (see the other WorkflowUtil::makespanBounds())
+     * @param dag: the workflow's DAG snapshot
+     * @param start_level: the first level
+     * @param end_level: the last level
+     * @param num_hosts
+     * @param core_speed
+     * @return a (lower bound, upper bound) pair
+     */
+    std::pair<double, double> WorkflowUtil::makespanBounds(const DagSnapshot &dag,
+                                                           unsigned long start_level, unsigned long end_level,
+                                                           unsigned long num_hosts, double core_speed) {
+        if ((start_level > end_level) or (start_level >= dag.getNumLevels())) {
+            return std::make_pair(0.0, 0.0);
+        }
+
+        if (num_hosts == 0) {
+            throw std::runtime_error("Cannot bound makespan with 0 hosts!");
+        }
+
+        end_level = std::min<unsigned long>(end_level, dag.getNumLevels() - 1);
+
+        // The tasks are a contiguous range of indices, in which parents come before their children
+        unsigned long first_task = dag.getLevelBegin(start_level);
+        unsigned long num_tasks = dag.getLevelEnd(end_level) - first_task;
+        std::vector<double> &finish_times = estimator_scratch.finish_times;
+        finish_times.assign(num_tasks, 0.0);
+        double critical_path = 0.0;
+        for (unsigned long k = 0; k < num_tasks; k++) {
+            double start_time = 0.0;
+            for (auto parent = dag.getParentsBegin(first_task + k); parent != dag.getParentsEnd(first_task + k); parent++) {
+                if (*parent >= first_task) {
+                    start_time = std::max<double>(start_time, finish_times[*parent - first_task]);
+                }
+            }
+            finish_times[k] = start_time + dag.getFlops(first_task + k) / core_speed;
+            critical_path = std::max<double>(critical_path, finish_times[k]);
+        }
+
+        double work = dag.getLevelRangeFlops(start_level, end_level) / core_speed;
+
+        return boundMakespan(critical_path, work, num_tasks, num_hosts);
+    }
+
+    /**
+     * @brief Set the maximum number of makespan estimates that are cached (0 disables the cache)
+     * @param capacity: a number of estimates
+     */
+    void WorkflowUtil::setMakespanCacheCapacity(unsigned long capacity) {
+        makespan_cache.capacity = capacity;
+        while (makespan_cache.entries.size() > capacity) {
+            makespan_cache.index.erase(makespan_cache.entries.back().first);
+            makespan_cache.entries.pop_back();
+        }
+    }
+
+    /**
+     * @brief Get the number of makespan estimates that were found in the cache
+     * @return a number of cache hits
+     */
+    unsigned long WorkflowUtil::getMakespanCacheHits() {
+        return makespan_cache.hits;
+    }
+
+    /**
+     * @brief Get the number of makespan estimates that had to be computed
+     * @return a number of cache misses
+     */
+    unsigned long WorkflowUtil::getMakespanCacheMisses() {
+        return makespan_cache.misses;
+    }
+
+    /**
+     * @brief Set up a list schedule of a set of tasks: everything that does not depend on the number of hosts
+     * @param dag: the workflow's DAG snapshot
+     * @param tasks: the indices of the tasks
+     * @param setup: the setup to fill in
+     */
+    static void setUpListSchedule(const DagSnapshot &dag, const std::vector<unsigned long> &tasks,
+                                  ListScheduleSetup &setup) {
+
+        // The priority is the task address, i.e., the order in which the former time-stepping
+        // implementation (which iterated over a std::set<WorkflowTask *>) considered tasks, so
+        // that makespans are unchanged.
+        // Reset the positions of the previous setup's tasks
+        for (auto task : setup.sorted_tasks) {
+            setup.positions[task] = ULONG_MAX;
+        }
+        if (setup.positions.size() < dag.getNumTasks()) {
+            setup.positions.resize(dag.getNumTasks(), ULONG_MAX);
+        }
+
+        setup.sorted_tasks.assign(tasks.begin(), tasks.end());
+        std::sort(setup.sorted_tasks.begin(), setup.sorted_tasks.end(), [&dag](unsigned long i, unsigned long j) -> bool {
+            return dag.getPriority(i) < dag.getPriority(j);
+        });
+        setup.sorted_tasks.erase(std::unique(setup.sorted_tasks.begin(), setup.sorted_tasks.end()),
+                                 setup.sorted_tasks.end());
+
+        unsigned long num_tasks = setup.sorted_tasks.size();
+
+        // Position of each DAG task in the set (ULONG_MAX if not in the set)
+        for (unsigned long i = 0; i < num_tasks; i++) {
+            setup.positions[setup.sorted_tasks[i]] = i;
+        }
+
+        // Count each task's parents in the set
+        setup.num_parents.assign(num_tasks, 0);
+        for (unsigned long i = 0; i < num_tasks; i++) {
+            for (auto parent = dag.getParentsBegin(setup.sorted_tasks[i]);
+                 parent != dag.getParentsEnd(setup.sorted_tasks[i]); parent++) {
+                if (setup.positions[*parent] != ULONG_MAX) {
+                    setup.num_parents[i]++;
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief A min-heap kept in a (cleared) scratch vector
+     */
+    template<typename T>
+    class ScratchHeap {
+    public:
+        explicit ScratchHeap(std::vector<T> &storage) : storage(storage) {
+            this->storage.clear();
+        }
+
+        bool empty() const { return this->storage.empty(); }
+
+        const T &top() const { return this->storage.front(); }
+
+        void push(const T &value) {
+            this->storage.push_back(value);
+            std::push_heap(this->storage.begin(), this->storage.end(), std::greater<T>());
+        }
+
+        void pop() {
+            std::pop_heap(this->storage.begin(), this->storage.end(), std::greater<T>());
+            this->storage.pop_back();
+        }
+
+    private:
+        std::vector<T> &storage;
+    };
+
+    typedef ScratchHeap<unsigned long> ReadyHeap;
+    typedef ScratchHeap<std::pair<double, unsigned long>> CompletionHeap;
+
+    /**
+     * @brief Compute the makespan of a list schedule of a set of tasks (see WorkflowUtil::estimateMakespan())
+     * @param dag: the workflow's DAG snapshot
+     * @param setup: the list schedule's setup
+     * @param num_hosts: a (non-zero) number of hosts
+     * @param core_speed: the core speed
+     * @param host_limited: set to whether a ready task ever had to wait for a host (if not, more
+     *        hosts would not change the schedule)
+     * @return a makespan
+     */
+    static double runListSchedule(const DagSnapshot &dag, const ListScheduleSetup &setup,
+                                  unsigned long num_hosts, double core_speed, bool *host_limited) {
+
+        // Greedy list scheduling, simulated event by event: whenever hosts are idle, ready tasks
+        // are started in priority order, and time then jumps to the next task completion.
+        const std::vector<unsigned long> &sorted_tasks = setup.sorted_tasks;
+        const std::vector<unsigned long> &positions = setup.positions;
+        unsigned long num_tasks = sorted_tasks.size();
+        std::vector<unsigned long> &num_pending_parents = estimator_scratch.num_pending_parents;
+        num_pending_parents.assign(setup.num_parents.begin(), setup.num_parents.end());
+        *host_limited = false;
+
+        // Ready tasks, lowest index (i.e., highest priority) first
+        ReadyHeap ready_tasks(estimator_scratch.ready_tasks);
+        // (completion date, task) for each busy host, earliest completion first
+        CompletionHeap running_tasks(estimator_scratch.running_tasks);
+        // Tasks made ready by a zero-duration task that has a lower priority than they have
+        std::vector<unsigned long> &deferred_tasks = estimator_scratch.deferred_tasks;
+        deferred_tasks.clear();
+
+        for (unsigned long i = 0; i < num_tasks; i++) {
+            if (num_pending_parents[i] == 0) {
+                ready_tasks.push(i);
+            }
+        }
+
+        unsigned long num_idle_hosts = num_hosts;
         unsigned long num_scheduled_tasks = 0;
         double current_time = 0.0;
+        double makespan = 0.0;
 
-        while (num_scheduled_tasks < num_tasks) {
-            bool scheduled_something = false;
-            std::set<WorkflowTask *> tasks_scheduled;
-
-            // Schedule Tasks
-            for (auto const &real_task : tasks_to_schedule) {
-                //WRENCH_INFO("LOOKING AT TASK %s", real_task->getID().c_str());
-                // Determine whether the task is schedulable
-                bool schedulable = true;
-                for (auto const &parent : lineage[real_task]) {
-                    if ((fake_tasks[parent] > current_time) or
-                        (fake_tasks[parent] < 0)) {
-                        schedulable = false;
-                        break;
-                    }
-                }
+        while (true) {
 
-                if (not schedulable) {
-//            WRENCH_INFO("NOT SCHEDULABLE");
+            // Start ready tasks on idle hosts
+            while ((num_idle_hosts > 0) and (not ready_tasks.empty())) {
+                unsigned long task = ready_tasks.top();
+                ready_tasks.pop();
+
+                double task_end_time = current_time + dag.getFlops(sorted_tasks[task]) / core_speed;
+                makespan = std::max<double>(makespan, task_end_time);
+                num_scheduled_tasks++;
+
+                if (task_end_time > current_time) {
+                    running_tasks.push(std::make_pair(task_end_time, task));
+                    num_idle_hosts--;
                     continue;
                 }
 
-                double task_end_time = current_time + real_task->getFlops() / core_speed;
-                for (unsigned int j=0; j < num_hosts; j++) {
-//            WRENCH_INFO("LOOKING AT HOST %d: %.2lf", j, idle_date[j]);
-                    if (idle_date[j] <= current_time) {
-//              WRENCH_INFO("SCHEDULING TASK on HOST %d", j);
-                        fake_tasks[real_task] = task_end_time;
-                        idle_date[j] = task_end_time;
-//              WRENCH_INFO("SCHEDULED TASK %s on host %d from time %.2lf-%.2lf",
-//                          real_task->getID().c_str(), j, current_time,
-//                          current_time + real_task->getFlops() / core_speed);
-                        scheduled_something = true;
-                        tasks_scheduled.insert(real_task);
-                        break;
-                    } else {
-//              WRENCH_INFO("THIS HOST DOESN'T WORK");
+                // A zero-duration task completes right away and does not hold its host
+                for (auto c = dag.getChildrenBegin(sorted_tasks[task]); c != dag.getChildrenEnd(sorted_tasks[task]); c++) {
+                    unsigned long child = positions[*c];
+                    if ((child != ULONG_MAX) and (--num_pending_parents[child] == 0)) {
+                        if (child > task) {
+                            ready_tasks.push(child);
+                        } else {
+                            deferred_tasks.push_back(child);
+                        }
                     }
                 }
             }
 
-            num_scheduled_tasks += tasks_scheduled.size();
-            for (auto &to_remove : tasks_scheduled) {
-                tasks_to_schedule.erase(to_remove);
+            if (not ready_tasks.empty()) {
+                *host_limited = true;
+            }
+
+            if (num_scheduled_tasks == num_tasks) {
+                break;
             }
 
-//        WRENCH_INFO("UPDATING CURRENT TIME");
-            if (scheduled_something) {
-                // Set current time to min idle time
-                double min_idle_time = idle_date[0];
-                for (unsigned int j = 1; j < num_hosts; j++) {
-                    min_idle_time = std::min<double>(idle_date[j], min_idle_time);
+            if (not deferred_tasks.empty()) {
+                for (auto task : deferred_tasks) {
+                    ready_tasks.push(task);
                 }
-                current_time = min_idle_time;
-            } else {
-                double second_min_idle_time = DBL_MAX;
-                for (unsigned int j = 0; j < num_hosts; j++) {
-                    if (idle_date[j] > current_time) {
-                        second_min_idle_time = std::min<double>(idle_date[j], second_min_idle_time);
+                deferred_tasks.clear();
+                continue;
+            }
+
+            if (running_tasks.empty()) {
+                throw std::runtime_error("estimateMakespan(): Cannot schedule tasks with cyclic dependencies!");
+            }
+
+            // Move to the next completion date, and release the children of all tasks that complete then
+            current_time = running_tasks.top().first;
+            while ((not running_tasks.empty()) and (running_tasks.top().first <= current_time)) {
+                unsigned long task = running_tasks.top().second;
+                running_tasks.pop();
+                num_idle_hosts++;
+                for (auto c = dag.getChildrenBegin(sorted_tasks[task]); c != dag.getChildrenEnd(sorted_tasks[task]); c++) {
+                    unsigned long child = positions[*c];
+                    if ((child != ULONG_MAX) and (--num_pending_parents[child] == 0)) {
+                        ready_tasks.push(child);
                     }
                 }
-                current_time = second_min_idle_time;
             }
-//        WRENCH_INFO("UPDATED CURRENT TIME TO %.2lf", current_time);
-        }
-
-        double makespan = idle_date[0];
-        for (unsigned int i=1; i < num_hosts; i++) {
-            makespan = std::max<double>(makespan, idle_date[i]);
         }
 
         return makespan;
@@ -12,17 +12,73 @@
 #define TASK_CLUSTERING_BATCH_SIMULATOR_WORKFLOWUTIL_H
 
 
+#include <string>
+#include <utility>
 #include <vector>
+#include <memory>
 
 namespace wrench {
 
+    class Workflow;
     class WorkflowTask;
+    class DagSnapshot;
 
+    /**
+     * @brief Workflow helpers, including the (cached) DAG snapshot of each workflow
+     *
+     * A workflow's dependency cache and DAG snapshot are kept up to date only if the workflow is
+     * modified through the WorkflowUtil::addTask(), WorkflowUtil::removeTask() and
+     * WorkflowUtil::addControlDependency() wrappers, once getDagSnapshot() has been called on it:
+     * modifications made directly on the workflow are detected only when they change its number of
+     * tasks (e.g., a direct Workflow::addControlDependency() call is not). Caches are keyed by workflow
+     * address and never dropped, as workflows live until the simulator exits: a workflow must not be
+     * destroyed while another one may be allocated at its address.
+     */
     class WorkflowUtil {
 
     public:
 
-        static double estimateMakespan(std::vector<WorkflowTask*> tasks, unsigned long num_hosts, double core_speed);
+        static std::shared_ptr<DagSnapshot> getDagSnapshot(Workflow *workflow);
+
+
+        static WorkflowTask *addTask(Workflow *workflow, std::string id, double flops,
+                                     unsigned long min_num_cores, unsigned long max_num_cores,
+                                     double parallel_efficiency);
+
+        static void removeTask(Workflow *workflow, WorkflowTask *task);
+
+        static void addControlDependency(Workflow *workflow, WorkflowTask *parent, WorkflowTask *child);
+
+        static double estimateMakespan(const std::vector<WorkflowTask*> &tasks, unsigned long num_hosts, double core_speed);
+
+        static double estimateMakespan(const DagSnapshot &dag, const std::vector<unsigned long> &tasks,
+                                       unsigned long num_hosts, double core_speed);
+
+        static double estimateMakespan(const DagSnapshot &dag, unsigned long start_level, unsigned long end_level,
+                                       unsigned long num_hosts, double core_speed);
+        static std::vector<double> estimateMakespanCurve(const std::vector<WorkflowTask*> &tasks,
+                                                         unsigned long max_hosts, double core_speed);
+
+        static std::vector<double> estimateMakespanCurve(const DagSnapshot &dag, const std::vector<unsigned long> &tasks,
+                                                         unsigned long max_hosts, double core_speed);
+
+        static std::vector<double> estimateMakespanCurve(const DagSnapshot &dag,
+                                                         unsigned long start_level, unsigned long end_level,
+                                                         unsigned long max_hosts, double core_speed);
+
+        static std::pair<double, double> makespanBounds(const DagSnapshot &dag, const std::vector<unsigned long> &tasks,
+                                                        unsigned long num_hosts, double core_speed);
+
+        static std::pair<double, double> makespanBounds(const DagSnapshot &dag,
+                                                        unsigned long start_level, unsigned long end_level,
+                                                        unsigned long num_hosts, double core_speed);
+
+        static void setMakespanCacheCapacity(unsigned long capacity);
+
+        static unsigned long getMakespanCacheHits();
+
+        static unsigned long getMakespanCacheMisses();
+
         static void printRAM();
 
     };
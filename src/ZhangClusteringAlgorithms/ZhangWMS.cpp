@@ -7,8 +7,12 @@
  * (at your option) any later version.
  */
 
+#include <cmath>
 #include "ZhangWMS.h"
 #include <Util/WorkflowUtil.h>
+#include <Util/DagSnapshot.h>
+#include <Util/LevelRangeSchedule.h>
+#include <Util/QueryProfiler.h>
 #include "assert.h"
 #include "Globals.h"
 
@@ -24,7 +28,8 @@ namespace wrench {
                        unsigned long max_num_jobs,
                        bool pick_globally_best_split,
                        bool binary_search_for_leeway,
-                       bool calculate_parallelism_based_on_predictions) :
+                       bool calculate_parallelism_based_on_predictions,
+                       bool use_wait_time_surface) :
             WMS(nullptr, nullptr, {batch_service}, {}, {}, nullptr, hostname, "zhang_wms") {
 
         this->simulator = simulator;
@@ -32,10 +37,13 @@ namespace wrench {
         this->pick_globally_best_split = pick_globally_best_split;
         this->binary_search_for_leeway = binary_search_for_leeway;
         this->calculate_parallelism_based_on_predictions = calculate_parallelism_based_on_predictions;
+        this->use_wait_time_surface = use_wait_time_surface;
         this->batch_service = batch_service;
         this->pending_placeholder_job = nullptr;
         this->individual_mode = false;
         this->number_of_splits = 0;
+        this->num_parallelism_probes = 0;
+        this->num_parallelism_probes_saved = 0;
     }
 
     int ZhangWMS::main() {
@@ -48,14 +56,21 @@ namespace wrench {
         this->number_of_hosts = this->batch_service->getNumHosts();
         this->num_jobs_in_system = 0;
         this->job_manager = this->createJobManager();
-        this->proxyWMS = new ProxyWMS(this->getWorkflow(), this->job_manager, this->batch_service);
+        this->proxyWMS = new ProxyWMS(this->getWorkflow(), this->job_manager, this->batch_service,
+                                      this->simulator->wait_time_predictor);
+        this->leeway_solver = new LeewaySolver(this->proxyWMS, &sequence);
 
         Globals::sim_json["individual_mode"] = false;
         Globals::sim_json["end_levels"] = std::vector<unsigned long> ();
+        Globals::sim_json["parallelism_search"]["mode"] = this->simulator->parallelism_search;
+        Globals::sim_json["parallelism_search"]["probes"] = 0;
+        Globals::sim_json["parallelism_search"]["probes_saved"] = 0;
 
         while (not this->getWorkflow()->isDone()) {
             applyGroupingHeuristic();
             this->waitForAndProcessNextEvent();
+            // The event may have changed the batch queue
+            this->proxyWMS->clearStartTimeEstimates();
         }
 
         assert(this->num_jobs_in_system == 0);
@@ -68,6 +83,7 @@ namespace wrench {
     }
 
     void ZhangWMS::applyGroupingHeuristic() {
+        QueryProfiler::Phase phase("grouping");
 
         if (this->pending_placeholder_job) {
             return;
@@ -84,6 +100,17 @@ namespace wrench {
             return;
         }
 
+        if (this->use_wait_time_surface) {
+            // Answer (almost) all wait time estimates below with a single batch service request: no
+            // requested execution time exceeds the total work plus the largest leeway
+            double parent_runtime = this->proxyWMS->findMaxDuration(this->running_placeholder_jobs);
+            double total_work = WorkflowUtil::getDagSnapshot(this->getWorkflow())->getLevelRangeFlops(
+                    start_level, end_level) / this->core_speed;
+            this->proxyWMS->buildWaitTimeSurface(start_level, end_level, bestParallelism(start_level, end_level, false),
+                                                 total_work + std::max<double>(parent_runtime, total_work),
+                                                 this->simulation->getCurrentSimulatedDate(), &sequence);
+        }
+
         std::tuple<double, double, double, unsigned long, unsigned long> partial_dag = groupLevels(start_level,
                                                                                                    end_level);
         double partial_dag_wait_time = std::get<0>(partial_dag);
@@ -105,7 +132,7 @@ namespace wrench {
             // calculate the runtime of entire DAG without predictions
             unsigned long max_parallelism = bestParallelism(start_level, end_level, false);
             double runtime_all = WorkflowUtil::estimateMakespan(
-                    this->getWorkflow()->getTasksInTopLevelRange(start_level, end_level),
+                    *WorkflowUtil::getDagSnapshot(this->getWorkflow()), start_level, end_level,
                     max_parallelism, this->core_speed);
             double wait_time_all = this->proxyWMS->estimateWaitTime(max_parallelism, runtime_all,
                                                                     this->simulation->getCurrentSimulatedDate(),
@@ -158,14 +185,26 @@ namespace wrench {
         // Start here
         unsigned long candidate_end_level = start_level;
 
+        // Carried from one candidate to the next: the widest level so far, and the schedule of the
+        // candidate's levels, which is only extended by one level while the number of nodes is unchanged
+        auto dag = WorkflowUtil::getDagSnapshot(this->getWorkflow());
+        unsigned long max_level_width = 0;
+        std::unique_ptr<LevelRangeSchedule> schedule;
+
         while (candidate_end_level <= end_level) {
 
             std::cout << "Candidate end level: " << candidate_end_level << std::endl;
 
-            unsigned long num_nodes = bestParallelism(start_level, candidate_end_level, false);
-            double runtime = WorkflowUtil::estimateMakespan(
-                    this->getWorkflow()->getTasksInTopLevelRange(start_level, candidate_end_level),
-                    num_nodes, this->core_speed);
+            // Same as bestParallelism(start_level, candidate_end_level, false)
+            max_level_width = std::max<unsigned long>(max_level_width, dag->getNumTasksInLevel(candidate_end_level));
+            unsigned long num_nodes = std::min<unsigned long>(max_level_width, this->number_of_hosts);
+            if ((schedule == nullptr) or (schedule->getNumHosts() != num_nodes)) {
+                schedule.reset(new LevelRangeSchedule(dag, start_level, candidate_end_level, num_nodes,
+                                                      this->core_speed));
+            } else {
+                schedule->extendTo(candidate_end_level);
+            }
+            double runtime = schedule->getMakespan();
             double wait_time = this->proxyWMS->estimateWaitTime(num_nodes, runtime,
                                                                 this->simulation->getCurrentSimulatedDate(),
                                                                 &sequence);
@@ -223,7 +262,7 @@ namespace wrench {
         if (this->calculate_parallelism_based_on_predictions) {
             num_nodes_for_best_grouping = bestParallelism(start_level, best_end_level, true);
             best_runtime = WorkflowUtil::estimateMakespan(
-                    this->getWorkflow()->getTasksInTopLevelRange(start_level, best_end_level),
+                    *WorkflowUtil::getDagSnapshot(this->getWorkflow()), start_level, best_end_level,
                     num_nodes_for_best_grouping, this->core_speed);
             best_wait_time = this->proxyWMS->estimateWaitTime(num_nodes_for_best_grouping, best_runtime,
                                                               this->simulation->getCurrentSimulatedDate(),
@@ -236,9 +275,10 @@ namespace wrench {
     }
 
     unsigned long ZhangWMS::bestParallelism(unsigned long start_level, unsigned long end_level, bool use_predictions) {
+        QueryProfiler::Phase phase("parallelism");
         unsigned long max_parallelism = 0;
         for (unsigned long i = start_level; i <= end_level; i++) {
-            unsigned long num_tasks_in_level = this->getWorkflow()->getTasksInTopLevelRange(i, i).size();
+            unsigned long num_tasks_in_level = WorkflowUtil::getDagSnapshot(this->getWorkflow())->getNumTasksInLevel(i);
             max_parallelism = std::max<unsigned long>(max_parallelism, num_tasks_in_level);
         }
 
@@ -248,16 +288,29 @@ namespace wrench {
             return max_parallelism;
         }
 
+        if (this->simulator->parallelism_search == "golden") {
+            return goldenSectionSearchForParallelism(start_level, end_level, max_parallelism);
+        }
+
         double parent_runtime = this->proxyWMS->findMaxDuration(this->running_placeholder_jobs);
 
+        std::vector<double> makespans = WorkflowUtil::estimateMakespanCurve(
+                *WorkflowUtil::getDagSnapshot(this->getWorkflow()), start_level, end_level,
+                max_parallelism, this->core_speed);
+
+        // Get the wait times of all node counts in one request
+        std::vector<std::pair<unsigned long, double>> configurations;
+        for (unsigned long i = 1; i < max_parallelism + 1; i++) {
+            configurations.push_back(std::make_pair(i, makespans[i - 1]));
+        }
+        std::vector<double> wait_times = this->proxyWMS->estimateWaitTimes(
+                configurations, this->simulation->getCurrentSimulatedDate(), &sequence);
+
         unsigned long best_parallelism = 0;
         double best_total_time = DBL_MAX;
         for (unsigned long i = 1; i < max_parallelism + 1; i++) {
-            double makespan = WorkflowUtil::estimateMakespan(
-                    this->getWorkflow()->getTasksInTopLevelRange(start_level, end_level),
-                    i, this->core_speed);
-            double wait_time = this->proxyWMS->estimateWaitTime(i, makespan,
-                                                                this->simulation->getCurrentSimulatedDate(), &sequence);
+            double makespan = makespans[i - 1];
+            double wait_time = wait_times[i - 1];
 
             if (wait_time < parent_runtime) { // We don't care if your wait time is smaller than the parent runtime!
                 wait_time = parent_runtime;
@@ -270,63 +323,110 @@ namespace wrench {
             }
         }
 
+        this->num_parallelism_probes += max_parallelism;
+        Globals::sim_json["parallelism_search"]["probes"] = this->num_parallelism_probes;
+
         return best_parallelism;
     }
 
-    double ZhangWMS::calculateLeeway(double wait_time, double runtime, unsigned long num_nodes) {
+    /**
+     * @brief Find the number of nodes that minimizes a job's total time (wait time, which is no less than
+     *        the parent job's runtime, plus makespan) with a golden-section search, which assumes that the
+     *        total time is unimodal in the number of nodes, followed by a check of the numbers of nodes
+     *        around the interval it ends with (in a single request)
+     * @param start_level: the job's first level
+     * @param end_level: the job's last level
+     * @param max_parallelism: the largest number of nodes
+     * @return a number of nodes (the smallest one of those with the lowest total time found)
+     */
+    unsigned long ZhangWMS::goldenSectionSearchForParallelism(unsigned long start_level, unsigned long end_level,
+                                                              unsigned long max_parallelism) {
+        const unsigned long NEIGHBORHOOD = 2;
+        const double INV_PHI = (std::sqrt(5.0) - 1.0) / 2.0;
+
+        auto dag = WorkflowUtil::getDagSnapshot(this->getWorkflow());
         double parent_runtime = this->proxyWMS->findMaxDuration(this->running_placeholder_jobs);
-        double leeway = parent_runtime - wait_time;
-        if (leeway <= 0) {
-            return 0;
+        std::map<unsigned long, double> total_times;
+
+        // Probe the numbers of nodes whose total times are not known yet, with one request
+        auto probe = [&](std::vector<unsigned long> num_nodes) {
+            std::vector<unsigned long> new_num_nodes;
+            std::vector<std::pair<unsigned long, double>> configurations;
+            for (auto n : num_nodes) {
+                if ((total_times.find(n) == total_times.end()) and
+                    (std::find(new_num_nodes.begin(), new_num_nodes.end(), n) == new_num_nodes.end())) {
+                    new_num_nodes.push_back(n);
+                    configurations.push_back(std::make_pair(
+                            n, WorkflowUtil::estimateMakespan(*dag, start_level, end_level, n, this->core_speed)));
+                }
+            }
+            if (configurations.empty()) {
+                return;
+            }
+            std::vector<double> wait_times = this->proxyWMS->estimateWaitTimes(
+                    configurations, this->simulation->getCurrentSimulatedDate(), &sequence);
+            for (unsigned long i = 0; i < configurations.size(); i++) {
+                total_times[new_num_nodes[i]] =
+                        configurations[i].second + std::max<double>(wait_times[i], parent_runtime);
+            }
+        };
+
+        unsigned long lower = 1;
+        unsigned long upper = max_parallelism;
+        while (upper - lower > 2 * NEIGHBORHOOD) {
+            unsigned long step = (unsigned long) std::round((upper - lower) * INV_PHI);
+            unsigned long x1 = upper - step;
+            unsigned long x2 = lower + step;
+            if (x1 >= x2) {
+                x2 = x1 + 1;
+            }
+            probe({x1, x2});
+            if (total_times[x1] <= total_times[x2]) {
+                upper = x2;
+            } else {
+                lower = x1;
+            }
         }
 
-        if (this->binary_search_for_leeway) {
-            return calculateLeewayBinarySearch(runtime, num_nodes, parent_runtime, 0, leeway);
-        } else {
-            return calculateLeewayZhangHeuristic(wait_time, runtime, num_nodes, parent_runtime);
+        // Check around the final interval
+        std::vector<unsigned long> num_nodes;
+        for (unsigned long n = (lower > NEIGHBORHOOD) ? lower - NEIGHBORHOOD : 1;
+             n <= std::min<unsigned long>(max_parallelism, upper + NEIGHBORHOOD); n++) {
+            num_nodes.push_back(n);
         }
-    }
-
-    double
-    ZhangWMS::calculateLeewayBinarySearch(double runtime, unsigned long num_nodes, double parent_runtime, double lower,
-                                          double upper) {
-        // std::cout << "LOWER: " << lower << " UPPER: " << upper << " greater? " << (lower >= upper) << std::endl;
-        assert(upper > 0 && lower >= 0);
+        probe(num_nodes);
 
-        if ((upper - lower) < 600) {
-            return upper;
+        unsigned long best_parallelism = 0;
+        double best_total_time = DBL_MAX;
+        for (auto const &total_time : total_times) {
+            if (total_time.second < best_total_time) {
+                best_total_time = total_time.second;
+                best_parallelism = total_time.first;
+            }
         }
 
-        double middle = floor((lower + upper) / 2.0);
-
-        double new_wait_time = this->proxyWMS->estimateWaitTime(num_nodes, (runtime + middle),
-                                                                this->simulation->getCurrentSimulatedDate(), &sequence);
-        // std::cout << "NEW WAIT TIME: " << new_wait_time << std::endl;
-        double new_leeway = parent_runtime - new_wait_time;
+        this->num_parallelism_probes += total_times.size();
+        this->num_parallelism_probes_saved += max_parallelism - total_times.size();
+        Globals::sim_json["parallelism_search"]["probes"] = this->num_parallelism_probes;
+        Globals::sim_json["parallelism_search"]["probes_saved"] = this->num_parallelism_probes_saved;
 
-        // not enough overlap :(
-        if (new_leeway >= 600) {
-            return calculateLeewayBinarySearch(runtime, num_nodes, parent_runtime, middle + 1, upper);
-        } else if (new_leeway < 0) {
-            return calculateLeewayBinarySearch(runtime, num_nodes, parent_runtime, lower, middle - 1);
-        }
-
-        // middle added was enough to create full overlap + (some slack < 10 minutes)
-        return middle;
+        return best_parallelism;
     }
 
-    double ZhangWMS::calculateLeewayZhangHeuristic(double wait_time, double runtime, unsigned long num_nodes,
-                                                   double parent_runtime) {
+    double ZhangWMS::calculateLeeway(double wait_time, double runtime, unsigned long num_nodes) {
+        double parent_runtime = this->proxyWMS->findMaxDuration(this->running_placeholder_jobs);
         double leeway = parent_runtime - wait_time;
-        assert(leeway > 0);
-        while ((leeway > 600) and
-               (this->proxyWMS->estimateWaitTime(num_nodes, runtime + leeway / 2.0,
-                                                 this->simulation->getCurrentSimulatedDate(), &sequence) >
-                parent_runtime)) {
-            leeway /= 2.0;
+        if (leeway <= 0) {
+            return 0;
         }
 
-        return leeway;
+        if (this->binary_search_for_leeway) {
+            return this->leeway_solver->findLeeway(runtime, num_nodes, parent_runtime, 0, leeway,
+                                                   this->simulation->getCurrentSimulatedDate());
+        } else {
+            return this->leeway_solver->findLeewayByHalving(wait_time, runtime, num_nodes, parent_runtime,
+                                                            this->simulation->getCurrentSimulatedDate());
+        }
     }
 
     void ZhangWMS::processEventPilotJobStart(std::shared_ptr<PilotJobStartedEvent> e) {
@@ -353,21 +453,30 @@ namespace wrench {
 
         PlaceHolderJob *placeholder_job = this->pending_placeholder_job;
         this->running_placeholder_jobs.insert(placeholder_job);
+        this->placeholder_registry.add(placeholder_job);
         this->pending_placeholder_job = nullptr;
 
+        placeholder_job->initializeReadyQueue(this->getWorkflow(), this->placeholder_registry.getCompletedTasks());
+
         // std::string output_string = "";
 
-        for (auto task : placeholder_job->tasks) {
-            if (task->getState() == WorkflowTask::State::READY  and (placeholder_job->num_standard_job_submitted < placeholder_job->num_hosts)) {
-                auto standard_job = this->job_manager->createStandardJob(task, {});
+        while (placeholder_job->num_standard_job_submitted < placeholder_job->num_hosts) {
+            WorkflowTask *task = placeholder_job->popReadyTask();
+            if (task == nullptr) {
+                break;
+            }
+            if (task->getState() != WorkflowTask::State::READY) {
+                // Already submitted as an individual job
+                continue;
+            }
+            auto standard_job = this->job_manager->createStandardJob(task, {});
 
-                // output_string += " " + task->getID();
+            // output_string += " " + task->getID();
 
-                WRENCH_INFO("Submitting task %s as part of placeholder job %ld-%ld",
-                            task->getID().c_str(), placeholder_job->start_level, placeholder_job->end_level);
-                this->job_manager->submitJob(standard_job, placeholder_job->pilot_job->getComputeService());
-                placeholder_job->num_standard_job_submitted++;
-            }
+            WRENCH_INFO("Submitting task %s as part of placeholder job %ld-%ld",
+                        task->getID().c_str(), placeholder_job->start_level, placeholder_job->end_level);
+            this->job_manager->submitJob(standard_job, placeholder_job->pilot_job->getComputeService());
+            placeholder_job->num_standard_job_submitted++;
         }
 
         this->applyGroupingHeuristic();
@@ -376,19 +485,15 @@ namespace wrench {
     void ZhangWMS::processEventPilotJobExpiration(std::shared_ptr<PilotJobExpiredEvent> e) {
         this->num_jobs_in_system--;
 
-        PlaceHolderJob *placeholder_job = nullptr;
-        for (auto ph : this->running_placeholder_jobs) {
-            if (ph->pilot_job == e->pilot_job) {
-                placeholder_job = ph;
-                break;
-            }
-        }
+        PlaceHolderJob *placeholder_job = this->placeholder_registry.getPlaceholderJob(e->pilot_job.get());
 
         if (placeholder_job == nullptr) {
             throw std::runtime_error("Got a pilot job expiration, but no matching placeholder job found");
         }
 
         this->running_placeholder_jobs.erase(placeholder_job);
+        this->placeholder_registry.remove(placeholder_job);
+        this->proxyWMS->notifyJobTermination(e->pilot_job.get());
 
         WRENCH_INFO("Got a pilot job expiration for a placeholder job that deals with levels %ld-%ld (%s)",
                     placeholder_job->start_level, placeholder_job->end_level,
@@ -426,6 +531,9 @@ namespace wrench {
 
         this->simulator->num_pilot_job_expirations_with_remaining_tasks_to_do++;
 
+        // Tasks of the expired placeholder job may be READY again
+        this->proxyWMS->resetReadyFrontier();
+
         WRENCH_INFO("This placeholder job has unprocessed tasks");
 
         if (this->pending_placeholder_job) {
@@ -434,7 +542,7 @@ namespace wrench {
                         (unsigned long) this->pending_placeholder_job,
                         (unsigned long) this->pending_placeholder_job->pilot_job.get(),
                         this->pending_placeholder_job->pilot_job->getName().c_str());
-            this->job_manager->terminateJob(this->pending_placeholder_job->pilot_job);
+            this->proxyWMS->terminateJob(this->pending_placeholder_job->pilot_job);
             this->pending_placeholder_job = nullptr;
         }
 
@@ -454,7 +562,7 @@ namespace wrench {
                             "of its tasks has started (%s)", ph->start_level, ph->end_level,
                             ph->pilot_job->getName().c_str());
                 try {
-                    this->job_manager->terminateJob(ph->pilot_job);
+                    this->proxyWMS->terminateJob(ph->pilot_job);
                 } catch (WorkflowExecutionException &e) {
                     // ignore (likely already dead!)
                 }
@@ -464,6 +572,7 @@ namespace wrench {
 
         for (auto ph : to_remove) {
             this->running_placeholder_jobs.erase(ph);
+            this->placeholder_registry.remove(ph);
         }
 
         this->applyGroupingHeuristic();
@@ -481,15 +590,14 @@ namespace wrench {
         this->simulator->used_node_seconds += completed_task->getFlops() / this->core_speed;
 
         // Find the placeholder job this task belongs to
-        PlaceHolderJob *placeholder_job = nullptr;
-        for (auto ph : this->running_placeholder_jobs) {
-            for (auto task : ph->tasks) {
-                if (task == completed_task) {
-                    placeholder_job = ph;
-                    break;
-                }
-            }
-        }
+        PlaceHolderJob *placeholder_job = this->placeholder_registry.getPlaceholderJob(completed_task);
+
+        // Queue the tasks, in running placeholder jobs or for individual submission, whose last
+        // uncompleted parent was the completed task
+        this->placeholder_registry.notifyTaskCompletion(completed_task, this->getWorkflow());
+        this->proxyWMS->notifyTaskCompletion(completed_task);
+        // In case the task was submitted individually
+        this->proxyWMS->notifyJobTermination(e->standard_job.get());
 
         if ((placeholder_job == nullptr) and (not this->individual_mode)) {
             throw std::runtime_error("Got a task completion, but couldn't find a placeholder for the task, "
@@ -534,49 +642,38 @@ namespace wrench {
                 try {
                     // hmm
                     WRENCH_INFO("TERMINATING A PILOT JOB");
-                    this->job_manager->terminateJob(placeholder_job->pilot_job);
+                    this->proxyWMS->terminateJob(placeholder_job->pilot_job);
                 } catch (WorkflowExecutionException &e) {
                     // ignore
                 }
                 this->running_placeholder_jobs.erase(placeholder_job);
+                this->placeholder_registry.remove(placeholder_job);
                 this->num_jobs_in_system--;
             }
         }
 
-        // Start all newly ready tasks that depended on the completed task, IN ANY PLACEHOLDER
-        std::vector<WorkflowTask *> children = this->getWorkflow()->getTaskChildren(completed_task);
+        // Start all newly ready tasks that depended on the completed task, IN ANY PLACEHOLDER,
+        // considering first tasks at the same level of completed_task
         for (auto ph : this->running_placeholder_jobs) {
-
-            // Start Other tasks if possible, considering first tasks at the same level of completed_task
-            for (auto task : ph->tasks) {
-                if ((task->getState() == WorkflowTask::READY) and
-                    (task->getTopLevel() == completed_task->getTopLevel()) and
-                    (ph->num_standard_job_submitted < ph->num_hosts)) {
-
-                    auto standard_job = this->job_manager->createStandardJob(task, {});
-                    // hmm
-                    WRENCH_INFO("Submitting task %s  as part of placeholder job %ld-%ld",
-                                task->getID().c_str(), placeholder_job->start_level, placeholder_job->end_level);
-                    this->job_manager->submitJob(standard_job, ph->pilot_job->getComputeService());
-
-                    ph->num_standard_job_submitted++;
-
+            while (ph->num_standard_job_submitted < ph->num_hosts) {
+                WorkflowTask *task = ph->popReadyTask(completed_task->getTopLevel());
+                if (task == nullptr) {
+                    task = ph->popReadyTask();
+                }
+                if (task == nullptr) {
+                    break;
+                }
+                if (task->getState() != WorkflowTask::READY) {
+                    // Already submitted as an individual job
+                    continue;
                 }
-            }
-
-            // Start Any other READY TASKS if possible
-            for (auto task : ph->tasks) {
-                if ((task->getState() == WorkflowTask::READY) and (ph->num_standard_job_submitted < ph->num_hosts)) {
-
-                    auto standard_job = this->job_manager->createStandardJob(task, {});
-                    // hmm
-                    WRENCH_INFO("Submitting task %s  as part of placeholder job %ld-%ld",
-                                task->getID().c_str(), placeholder_job->start_level, placeholder_job->end_level);
-                    this->job_manager->submitJob(standard_job, ph->pilot_job->getComputeService());
 
-                    ph->num_standard_job_submitted++;
+                auto standard_job = this->job_manager->createStandardJob(task, {});
+                WRENCH_INFO("Submitting task %s  as part of placeholder job %ld-%ld",
+                            task->getID().c_str(), ph->start_level, ph->end_level);
+                this->job_manager->submitJob(standard_job, ph->pilot_job->getComputeService());
 
-                }
+                ph->num_standard_job_submitted++;
             }
         }
 
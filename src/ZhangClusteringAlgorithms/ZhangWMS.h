@@ -14,6 +14,8 @@
 #include "Simulator.h"
 #include <Util/PlaceHolderJob.h>
 #include <Util/ProxyWMS.h>
+#include <Util/LeewaySolver.h>
+#include <Util/PlaceholderRegistry.h>
 
 namespace wrench {
 
@@ -27,7 +29,8 @@ namespace wrench {
                  unsigned long max_num_jobs,
                  bool pick_globally_best_split,
                  bool binary_search_for_leeway,
-                 bool calculate_parallelism_based_on_predictions);
+                 bool calculate_parallelism_based_on_predictions,
+                 bool use_wait_time_surface);
 
     private:
 
@@ -38,6 +41,7 @@ namespace wrench {
         bool pick_globally_best_split;
         bool binary_search_for_leeway;
         bool calculate_parallelism_based_on_predictions;
+        bool use_wait_time_surface;
 
         int main() override;
 
@@ -48,13 +52,10 @@ namespace wrench {
 
         unsigned long bestParallelism(unsigned long start_level, unsigned long end_level, bool use_predictions);
 
-        double calculateLeeway(double wait_time, double runtime, unsigned long num_nodes);
-
-        double calculateLeewayBinarySearch(double runtime, unsigned long num_nodes, double parent_runtime, double lower,
-                                           double upper);
+        unsigned long goldenSectionSearchForParallelism(unsigned long start_level, unsigned long end_level,
+                                                        unsigned long max_parallelism);
 
-        double calculateLeewayZhangHeuristic(double wait_time, double runtime, unsigned long num_nodes,
-                                             double parent_runtime);
+        double calculateLeeway(double wait_time, double runtime, unsigned long num_nodes);
 
         void processEventPilotJobStart(std::shared_ptr<PilotJobStartedEvent> e) override;
 
@@ -70,6 +71,7 @@ namespace wrench {
 
         PlaceHolderJob *pending_placeholder_job;
         std::set<PlaceHolderJob *> running_placeholder_jobs;
+        PlaceholderRegistry placeholder_registry;
         double core_speed;
         unsigned long number_of_hosts;
         unsigned long num_jobs_in_system;
@@ -77,10 +79,16 @@ namespace wrench {
         std::shared_ptr<JobManager> job_manager;
 
         ProxyWMS *proxyWMS;
+        LeewaySolver *leeway_solver;
 
         // Number of times the workflow was split
         unsigned long number_of_splits;
 
+        // Number of node counts probed when picking parallelism based on predictions, and number of
+        // probes that a golden-section search saved compared to trying them all
+        unsigned long num_parallelism_probes;
+        unsigned long num_parallelism_probes_saved;
+
     };
 
 }